@@ -0,0 +1,99 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <engine/core/collider.hpp>
+#include <engine/core/transform.hpp>
+
+using namespace Engine;
+
+// Minkowski difference support queries per second, the inner operation of GJK and EPA, for colliders held two ways.
+// Virtual is how Physics held its collider before ColliderVariant, a shared pointer to a heap allocated collider with a virtual GetSupport.
+// Variant is ColliderVariant stored by value, dispatching on the shape with a switch the support mapping inlines into.
+// Shapes are mixed at random, so neither version gets a branch it can always predict.
+// Usage: support [queries in millions]
+
+namespace
+{
+    struct VirtualSupport
+    {
+        virtual ~VirtualSupport() = default;
+        virtual Vector3 GetSupport(const Vector3& direction) const = 0;
+    };
+
+    template <ColliderConcept T>
+    struct VirtualCollider : VirtualSupport
+    {
+        T collider;
+
+        VirtualCollider(const T& collider) : collider(collider) {}
+        Vector3 GetSupport(const Vector3& direction) const override { return collider.GetSupport(direction); }
+    };
+
+    constexpr size_t s_BodyCount = 64;
+    constexpr size_t s_DirectionCount = 1024;
+
+    template <typename F>
+    double Measure(size_t queries, Vector3& sum, F&& support)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t query = 0; query < queries; ++query) sum += support(query & (s_BodyCount - 1), (query * 7 + 3) & (s_BodyCount - 1), query & (s_DirectionCount - 1));
+        return queries / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t queries = (argc > 1 ? std::stoul(argv[1]) : 20) * 1000000;
+
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> shape(0, 2);
+    std::vector<std::shared_ptr<VirtualSupport>> pointers;
+    std::vector<ColliderVariant> variants;
+    std::vector<Frame> frames;
+    for (size_t index = 0; index < s_BodyCount; ++index)
+    {
+        switch (shape(random))
+        {
+            case 0:
+                pointers.push_back(std::make_shared<VirtualCollider<CubeCollider>>(CubeCollider(2.0f)));
+                variants.push_back(CubeCollider(2.0f));
+                break;
+            case 1:
+                pointers.push_back(std::make_shared<VirtualCollider<SphereCollider>>(SphereCollider(1.0f)));
+                variants.push_back(SphereCollider(1.0f));
+                break;
+            default:
+                pointers.push_back(std::make_shared<VirtualCollider<CapsuleCollider>>(CapsuleCollider(0.5f, 1.0f)));
+                variants.push_back(CapsuleCollider(0.5f, 1.0f));
+                break;
+        }
+        Transform transform;
+        transform.TranslateTo(unit(random), unit(random), unit(random));
+        transform.RotateBy(unit(random), unit(random), unit(random));
+        frames.push_back(transform.GetFrame());
+    }
+    std::vector<Vector3> directions;
+    for (size_t index = 0; index < s_DirectionCount; ++index) directions.push_back(Vector3(unit(random), unit(random), unit(random)));
+
+    // The sums keep the queries from being optimized away, they match up to the summation order -ffast-math is free to change.
+    Vector3 virtualSum = Vector3(0.0f);
+    Vector3 variantSum = Vector3(0.0f);
+    double virtualRate = Measure(queries, virtualSum, [&](size_t a, size_t b, size_t direction)
+    {
+        Vector3 pointA = frames[a].ToWorldPoint(pointers[a]->GetSupport(frames[a].ToLocalDirection(directions[direction])));
+        Vector3 pointB = frames[b].ToWorldPoint(pointers[b]->GetSupport(frames[b].ToLocalDirection(-directions[direction])));
+        return pointA - pointB;
+    });
+    double variantRate = Measure(queries, variantSum, [&](size_t a, size_t b, size_t direction)
+    {
+        return variants[a].GetWorldSupport(frames[a], directions[direction]) - variants[b].GetWorldSupport(frames[b], -directions[direction]);
+    });
+
+    std::printf("%zu M queries over %zu cubes, spheres and capsules\n", queries / 1000000, s_BodyCount);
+    std::printf("virtual %6.2f M queries/s, variant %6.2f M queries/s (%.2fx), sums %g %g\n", virtualRate * 1e-6, variantRate * 1e-6, variantRate / virtualRate, virtualSum.x, variantSum.x);
+    return 0;
+}
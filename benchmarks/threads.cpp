@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <engine/core/world.hpp>
+#include <engine/core/object.hpp>
+#include <engine/core/physics.hpp>
+#include <engine/core/solver.hpp>
+#include <engine/core/transform.hpp>
+#include <engine/core/collider.hpp>
+
+using namespace Engine;
+
+// Step time for a pile of 10k cubes, spheres and ellipsoids falling onto a plane, from one thread up to the core count.
+// The pile is rebuilt for every thread count and stepped from the start, so every run does the same work.
+// The pose hash at the end must match across thread counts, the solver gives the same results whatever the thread count.
+// Usage: threads [max threads] [steps]
+
+namespace
+{
+    void Populate(World& world)
+    {
+        Object ground = world.Create();
+        ground.Add<Transform>(Transform());
+        ground.Add<Physics>(Physics(PlaneCollider(1000.0f), true));
+
+        size_t count = 0;
+        for (size_t layer = 0; layer < 25; ++layer)
+        {
+            for (size_t row = 0; row < 20; ++row)
+            {
+                for (size_t column = 0; column < 20; ++column, ++count)
+                {
+                    Object object = world.Create();
+                    Transform transform;
+                    transform.TranslateTo(2.1f * row + 0.1f * (layer % 3), 2.1f * column, 1.0f + 2.1f * layer);
+                    transform.RotateBy(Radians(7.0f * layer), Radians(3.0f * row), 0.0f);
+                    if (count % 3 == 2) transform.ScaleTo(1.0f, 0.8f, 0.9f);
+                    object.Add<Transform>(transform);
+                    if (count % 3 == 0) object.Add<Physics>(Physics(CubeCollider(2.0f)));
+                    else object.Add<Physics>(Physics(SphereCollider(1.0f)));
+                }
+            }
+        }
+    }
+
+    uint64_t HashPoses(World& world)
+    {
+        uint64_t hash = 1469598103934665603ull;
+        for (auto [handle, transform, physics] : world.View<Transform, Physics>())
+        {
+            Vector3 position = transform.GetPosition();
+            Quaternion orientation = transform.GetOrientation();
+            float values[7] = { position.x, position.y, position.z, orientation.a, orientation.b, orientation.c, orientation.d };
+            unsigned char bytes[sizeof(values)];
+            std::memcpy(bytes, values, sizeof(values));
+            for (unsigned char byte : bytes) hash = (hash ^ byte) * 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+    size_t maxThreads = argc > 1 ? std::stoul(argv[1]) : cores;
+    size_t steps = argc > 2 ? std::stoul(argv[2]) : 120;
+    std::printf("10000 bodies, %zu steps, %zu hardware threads\n", steps, cores);
+    if (maxThreads > cores) std::printf("More threads than hardware threads, the extra ones only share cores.\n");
+
+    double baseline = 0.0;
+    for (size_t threads = 1; threads <= maxThreads; ++threads)
+    {
+        World world;
+        Solver solver;
+        solver.SetThreadCount(threads);
+        Populate(world);
+
+        double stepTime = 0.0;
+        double narrowphaseTime = 0.0;
+        size_t pairs = 0;
+        size_t contacts = 0;
+        for (size_t step = 0; step < steps; ++step)
+        {
+            auto start = std::chrono::steady_clock::now();
+            solver.Solve(world, 1.0f / 60.0f);
+            stepTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            narrowphaseTime += solver.GetStatistics().narrowphaseTime;
+            pairs += solver.GetStatistics().narrowphasePairs;
+            contacts += solver.GetStatistics().contacts;
+        }
+        if (threads == 1) baseline = stepTime;
+        std::printf("%2zu threads: step %7.2f ms (%.2fx), narrowphase %6.2f ms, %zu pairs and %zu contact rows per step, poses %016llx\n", threads, stepTime * 1e3 / steps, baseline / stepTime,
+            narrowphaseTime * 1e3 / steps, pairs / steps, contacts / steps, static_cast<unsigned long long>(HashPoses(world)));
+    }
+    return 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <engine/core/math.hpp>
+
+namespace Engine
+{
+    struct Bounds
+    {
+        Vector3 min = Vector3(0.0f);
+        Vector3 max = Vector3(0.0f);
+
+        constexpr Bounds() = default;
+        constexpr Bounds(const Vector3& min, const Vector3& max) : min(min), max(max) {}
+        ~Bounds() = default;
+
+        inline Vector3 GetCenter() const { return (min + max) * 0.5f; }
+        inline Vector3 GetExtents() const { return (max - min) * 0.5f; }
+        inline float GetSurfaceArea() const
+        {
+            Vector3 size = max - min;
+            return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+        inline bool Contains(const Bounds& other) const
+        {
+            return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+                   max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+        }
+        inline bool Overlaps(const Bounds& other) const
+        {
+            return min.x <= other.max.x && max.x >= other.min.x &&
+                   min.y <= other.max.y && max.y >= other.min.y &&
+                   min.z <= other.max.z && max.z >= other.min.z;
+        }
+
+    };
+
+    inline Bounds Merged(const Bounds& a, const Bounds& b)
+    {
+        return Bounds(
+            Vector3(Min(a.min.x, b.min.x), Min(a.min.y, b.min.y), Min(a.min.z, b.min.z)),
+            Vector3(Max(a.max.x, b.max.x), Max(a.max.y, b.max.y), Max(a.max.z, b.max.z))
+        );
+    }
+    inline Bounds Inflated(const Bounds& bounds, float margin) { return Bounds(bounds.min - Vector3(margin), bounds.max + Vector3(margin)); }
+}
@@ -0,0 +1,192 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <concepts>
+#include <engine/core/bounds.hpp>
+
+namespace Engine
+{
+    class Broadphase
+    {
+        public:
+
+        struct Proxy
+        {
+            uint32_t id;    // Stable between steps, lets incremental broadphases keep their state.
+            Bounds bounds;
+        };
+
+        struct Pair
+        {
+            uint32_t a;     // Indices into the proxy list given to Update, a < b.
+            uint32_t b;
+        };
+
+        struct Statistics
+        {
+            float buildTime = 0.0f;     // Seconds spent inserting and removing proxies.
+            float refitTime = 0.0f;     // Seconds spent bringing moved proxies up to date.
+            float queryTime = 0.0f;     // Seconds spent generating pairs.
+            size_t pairCount = 0;
+        };
+
+        Broadphase() = default;
+        virtual ~Broadphase() = default;
+        virtual void Update(const std::vector<Proxy>& proxies, std::vector<Pair>& pairs) = 0;
+        const Statistics& GetStatistics() const { return m_Statistics; }
+
+        protected:
+
+        Statistics m_Statistics;
+
+    };
+
+    template <typename T>
+    concept BroadphaseConcept = std::derived_from<T, Broadphase>;
+
+    class BruteForce : public Broadphase
+    {
+        public:
+
+        BruteForce() = default;
+        ~BruteForce() = default;
+
+        void Update(const std::vector<Proxy>& proxies, std::vector<Pair>& pairs) override;
+
+    };
+
+    class SweepAndPrune : public Broadphase
+    {
+        private:
+
+        static constexpr size_t s_InsertionSortLimit = 16;
+
+        struct Endpoint
+        {
+            float value;
+            uint32_t slot;
+            bool maximum;
+
+            inline bool operator<(const Endpoint& other) const { return value < other.value || (value == other.value && maximum < other.maximum); }
+        };
+
+        struct Slot
+        {
+            Bounds bounds;
+            uint32_t proxy = 0;
+            uint32_t stamp = 0;
+            bool inserted = false;
+        };
+
+        std::vector<Endpoint> m_Axes[3];
+        std::vector<Slot> m_Slots;      // Indexed by proxy id.
+        std::vector<uint32_t> m_Active;
+        uint32_t m_Stamp = 0;
+        size_t m_InsertedCount = 0;
+
+        public:
+
+        SweepAndPrune() = default;
+        ~SweepAndPrune() = default;
+
+        void Update(const std::vector<Proxy>& proxies, std::vector<Pair>& pairs) override;
+
+    };
+
+    class DynamicTree : public Broadphase
+    {
+        private:
+
+        static constexpr uint32_t s_Null = UINT32_MAX;
+
+        struct Node
+        {
+            Bounds bounds;                  // Fat bounds for leaves.
+            uint32_t parent = s_Null;       // Next free node while on the free list.
+            uint32_t children[2] = { s_Null, s_Null };
+            uint32_t slot = s_Null;
+            int32_t height = 0;
+
+            inline bool IsLeaf() const { return children[0] == s_Null; }
+        };
+
+        struct Slot
+        {
+            Bounds bounds;
+            uint32_t leaf = s_Null;
+            uint32_t proxy = 0;
+            uint32_t stamp = 0;
+        };
+
+        float m_Margin = 0.2f;
+        uint32_t m_Root = s_Null;
+        uint32_t m_FreeList = s_Null;
+        uint32_t m_Stamp = 0;
+        size_t m_LeafCount = 0;
+        std::vector<Node> m_Nodes;
+        std::vector<Slot> m_Slots;      // Indexed by proxy id.
+        std::vector<uint32_t> m_Moved;
+        std::vector<std::pair<uint32_t, uint32_t>> m_Stack;
+
+        uint32_t AllocateNode();
+        void FreeNode(uint32_t node);
+        void InsertLeaf(uint32_t leaf);
+        void RemoveLeaf(uint32_t leaf);
+        void Refit(uint32_t node);
+        uint32_t Balance(uint32_t node);
+
+        public:
+
+        DynamicTree() = default;
+        DynamicTree(float margin);
+        ~DynamicTree() = default;
+
+        float GetMargin() const;
+        void SetMargin(float margin);
+        size_t GetHeight() const;
+        void Update(const std::vector<Proxy>& proxies, std::vector<Pair>& pairs) override;
+
+    };
+
+    class SpatialHash : public Broadphase
+    {
+        private:
+
+        static constexpr size_t s_MaxCellsPerProxy = 64;   // Larger proxies skip the grid and are tested against every proxy.
+
+        struct Cell
+        {
+            int32_t x;
+            int32_t y;
+            int32_t z;
+            uint32_t stamp = 0;     // Cells not stamped with the current step are empty.
+            uint32_t begin;
+            uint32_t count;
+        };
+
+        float m_CellSize = 2.0f;
+        float m_InverseCellSize = 0.5f;
+        uint32_t m_Stamp = 0;
+        std::vector<Cell> m_Cells;      // Open addressed with linear probing, power of two capacity.
+        std::vector<uint32_t> m_Occupied;
+        std::vector<uint32_t> m_Entries;
+        std::vector<std::pair<uint32_t, uint32_t>> m_Insertions;
+        std::vector<uint32_t> m_Oversized;
+        std::vector<bool> m_IsOversized;
+
+        inline int32_t GetCellCoordinate(float value) const { return static_cast<int32_t>(Floor(value * m_InverseCellSize)); }
+        uint32_t FindOrInsertCell(int32_t x, int32_t y, int32_t z);
+
+        public:
+
+        SpatialHash() = default;
+        SpatialHash(float cellSize);
+        ~SpatialHash() = default;
+
+        float GetCellSize() const;
+        void SetCellSize(float cellSize);
+        void Update(const std::vector<Proxy>& proxies, std::vector<Pair>& pairs) override;
+
+    };
+}
@@ -1,6 +1,14 @@
 #pragma once
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include <variant>
+#include <unordered_map>
 #include <engine/core/math.hpp>
+#include <engine/core/bounds.hpp>
 #include <engine/core/transform.hpp>
+#include <engine/core/simd.hpp>
 
 namespace Engine
 {
@@ -16,24 +24,30 @@ namespace Engine
             Rectangle,
             Sphere,
             Capsule,
-            Mesh
+            Triangle,
+            TriangleMesh,
+            Heightfield,
+            Mesh    // Keep this last, the solver sizes its collision dispatch table from it.
         };
 
         Collider() = default;
         ~Collider() = default;
-        virtual Matrix3 GetInertiaTensor(float mass) const = 0;
-        virtual Matrix3 GetInverseInertiaTensor(float mass) const final;
-        virtual Vector3 GetSupport(const Vector3& direction) const = 0;
-        virtual Vector3 GetWorldSupport(const Transform& transform, const Vector3& direction) const final;
+        Shape GetShape() const;
         
         protected:
 
+        Collider(Shape shape) : m_Shape(shape) {}
+
         Shape m_Shape = Shape::Unknown;
 
     };
 
     template <typename T>
-    concept ColliderConcept = std::derived_from<T, Collider>;
+    concept ColliderConcept = std::derived_from<T, Collider> && requires(const T& collider, const Vector3& direction, float mass)
+    {
+        { collider.GetSupport(direction) } -> std::same_as<Vector3>;
+        { collider.GetInertiaTensor(mass) } -> std::same_as<Matrix3>;
+    };
 
     class CubeCollider : public Collider
     {
@@ -43,12 +57,20 @@ namespace Engine
         
         public:
         
-        CubeCollider() = default;
+        CubeCollider() : Collider(Shape::Cube) {}
         CubeCollider(float length);
         ~CubeCollider() = default;
 
-        Matrix3 GetInertiaTensor(float mass) const override;
-        Vector3 GetSupport(const Vector3& direction) const override;
+        float GetHalfLength() const;
+        Matrix3 GetInertiaTensor(float mass) const;
+        inline Vector3 GetSupport(const Vector3& direction) const
+        {
+            return Vector3(
+                (direction.x >= 0) ? m_HalfLength : -m_HalfLength,
+                (direction.y >= 0) ? m_HalfLength : -m_HalfLength,
+                (direction.z >= 0) ? m_HalfLength : -m_HalfLength
+            );
+        }
 
     };
 
@@ -60,12 +82,20 @@ namespace Engine
         
         public:
         
-        PlaneCollider() = default;
+        PlaneCollider() : Collider(Shape::Plane) {}
         PlaneCollider(float length);
         ~PlaneCollider() = default;
 
-        Matrix3 GetInertiaTensor(float mass) const override;
-        Vector3 GetSupport(const Vector3& direction) const override;
+        float GetHalfLength() const;
+        Matrix3 GetInertiaTensor(float mass) const;
+        inline Vector3 GetSupport(const Vector3& direction) const
+        {
+            return Vector3(
+                (direction.x >= 0) ? m_HalfLength : -m_HalfLength,
+                (direction.y >= 0) ? m_HalfLength : -m_HalfLength,
+                0.0f
+            );
+        }
 
     };
 
@@ -77,12 +107,360 @@ namespace Engine
         
         public:
         
-        SphereCollider() = default;
+        SphereCollider() : Collider(Shape::Sphere) {}
         SphereCollider(float radius);
         ~SphereCollider() = default;
 
-        Matrix3 GetInertiaTensor(float mass) const override;
-        Vector3 GetSupport(const Vector3& direction) const override;
+        float GetRadius() const;
+        Matrix3 GetInertiaTensor(float mass) const;
+        inline Vector3 GetSupport(const Vector3& direction) const { return Normalized(direction) * m_Radius; }
+
+    };
+
+    // Segment along the local z axis swept by a sphere.
+    class CapsuleCollider : public Collider
+    {
+        private:
+
+        float m_Radius = 0.5;
+        float m_HalfLength = 0.5;   // Half the distance between the cap centres.
+
+        public:
+
+        CapsuleCollider() : Collider(Shape::Capsule) {}
+        CapsuleCollider(float radius, float length);
+        ~CapsuleCollider() = default;
+
+        float GetRadius() const;
+        float GetHalfLength() const;
+        Matrix3 GetInertiaTensor(float mass) const;
+        inline Vector3 GetSupport(const Vector3& direction) const
+        {
+            return Vector3(0.0f, 0.0f, (direction.z >= 0) ? m_HalfLength : -m_HalfLength) + Normalized(direction) * m_Radius;
+        }
+
+    };
+
+    class ConvexHullCollider : public Collider
+    {
+        private:
+
+        // Built once per file and shared by every collider made from it.
+        struct Hull
+        {
+            std::vector<Vector3> vertices;
+            std::vector<uint32_t> neighbourOffsets;     // Range in the neighbours of every vertex, closed by the neighbour count.
+            std::vector<uint32_t> neighbours;           // Vertices sharing a hull edge.
+            Matrix3 inertia = Matrix3(1.0f);            // Solid hull of unit mass, about its centroid.
+
+            Hull(std::vector<Vector3> points);
+        };
+
+        static std::unordered_map<std::string, std::weak_ptr<const Hull>> s_Cache;
+
+        std::shared_ptr<const Hull> mp_Hull;
+
+        public:
+
+        ConvexHullCollider(const std::string& path);
+        ConvexHullCollider(const std::vector<Vector3>& points);
+        ~ConvexHullCollider() = default;
+
+        size_t GetVertexCount() const;
+        Matrix3 GetInertiaTensor(float mass) const;
+        inline Vector3 GetSupport(const Vector3& direction) const
+        {
+            uint32_t hint = 0;
+            return GetSupport(direction, hint);
+        }
+        inline Vector3 GetSupport(const Vector3& direction, uint32_t& hint) const
+        {
+            // Walks to the neighbour furthest along the direction until none is further, on a convex hull that local maximum is the global one.
+            // Starts from the hint and leaves the vertex it ended on there, the narrowphase keeps one per pair so the next query of the pair climbs from it.
+            // On a face flat along the direction the climb stops at the first vertex of the face it reaches, which only depends on the hint.
+            const Hull& hull = *mp_Hull;
+            uint32_t vertex = hint < hull.vertices.size() ? hint : 0;
+            float distance = Dot(hull.vertices[vertex], direction);
+            for (uint32_t previous = ~0u; previous != vertex;)
+            {
+                previous = vertex;
+                for (uint32_t index = hull.neighbourOffsets[previous]; index < hull.neighbourOffsets[previous + 1]; ++index)
+                {
+                    uint32_t neighbour = hull.neighbours[index];
+                    float neighbourDistance = Dot(hull.vertices[neighbour], direction);
+                    if (neighbourDistance <= distance) continue;
+                    distance = neighbourDistance;
+                    vertex = neighbour;
+                }
+            }
+            hint = vertex;
+            return hull.vertices[vertex];
+        }
+
+    };
+
+    // Two sided, meshes hand their triangles to the narrowphase as these.
+    class TriangleCollider : public Collider
+    {
+        private:
+
+        Vector3 m_Vertices[3] = { Vector3(0.0f), Vector3(1.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f) };
+
+        public:
+
+        TriangleCollider() : Collider(Shape::Triangle) {}
+        TriangleCollider(const Vector3& a, const Vector3& b, const Vector3& c);
+        ~TriangleCollider() = default;
+
+        const Vector3& GetVertex(size_t index) const;
+        Matrix3 GetInertiaTensor(float mass) const;
+        inline Vector3 GetSupport(const Vector3& direction) const
+        {
+            float a = Dot(m_Vertices[0], direction);
+            float b = Dot(m_Vertices[1], direction);
+            float c = Dot(m_Vertices[2], direction);
+            if (a >= b && a >= c) return m_Vertices[0];
+            return (b >= c) ? m_Vertices[1] : m_Vertices[2];
+        }
+
+    };
+
+    // Static geometry only, Physics refuses it on bodies that aren't stationary. The support is a corner of the bounds, the narrowphase tests the triangles under a body instead.
+    class TriangleMeshCollider : public Collider
+    {
+        public:
+
+        // Inner nodes are followed by their first child and point to the second, leaves point to the packet with their triangles.
+        struct Node
+        {
+            Vector3 min;
+            uint32_t offset;
+            Vector3 max;
+            uint32_t count;     // Triangles in a leaf, zero for inner nodes.
+        };
+
+        // A leaf's triangles stored lane by lane, so they load straight into SIMD registers. Unused lanes repeat the first triangle.
+        struct TrianglePacket
+        {
+            float vertices[3][3][LaneCount];    // Vertex, then component.
+        };
+
+        private:
+
+        // Built once per file and shared by every collider made from it.
+        struct Tree
+        {
+            std::vector<Node> nodes;
+            std::vector<TrianglePacket> packets;
+            size_t triangleCount = 0;
+
+            Tree(const std::vector<Vector3>& positions, const std::vector<uint32_t>& indices);
+        };
+
+        static std::unordered_map<std::string, std::weak_ptr<const Tree>> s_Cache;
+        static constexpr size_t s_MaxDepth = 64;
+
+        std::shared_ptr<const Tree> mp_Tree;
+
+        public:
+
+        TriangleMeshCollider(const std::string& path);
+        TriangleMeshCollider(const std::vector<Vector3>& positions, const std::vector<uint32_t>& indices);
+        ~TriangleMeshCollider() = default;
+
+        size_t GetTriangleCount() const;
+        size_t GetNodeCount() const;
+        Matrix3 GetInertiaTensor(float mass) const;
+        inline Vector3 GetSupport(const Vector3& direction) const
+        {
+            const Node& root = mp_Tree->nodes[0];
+            return Vector3(
+                (direction.x >= 0) ? root.max.x : root.min.x,
+                (direction.y >= 0) ? root.max.y : root.min.y,
+                (direction.z >= 0) ? root.max.z : root.min.z
+            );
+        }
+
+        // Calls visit(packet, count) for every leaf overlapping the bounds, given in the mesh's space.
+        template <typename F>
+        void Query(const Bounds& bounds, F&& visit) const
+        {
+            const Tree& tree = *mp_Tree;
+            uint32_t stack[s_MaxDepth];
+            size_t size = 0;
+            uint32_t index = 0;
+            while (true)
+            {
+                const Node& node = tree.nodes[index];
+                if (Bounds(node.min, node.max).Overlaps(bounds))
+                {
+                    if (node.count == 0)
+                    {
+                        stack[size++] = node.offset;
+                        ++index;
+                        continue;
+                    }
+                    visit(tree.packets[node.offset], node.count);
+                }
+                if (size == 0) return;
+                index = stack[--size];
+            }
+        }
+
+    };
+
+    // Static terrain on a regular grid centered on the origin, two bytes per sample. Like triangle meshes it only goes on stationary bodies. The triangles of the cells under a body are made when it asks for them.
+    class HeightfieldCollider : public Collider
+    {
+        private:
+
+        std::shared_ptr<const std::vector<uint16_t>> mp_Samples;   // Row by row, rows run along y.
+        size_t m_Columns = 0;
+        size_t m_Rows = 0;
+        Vector3 m_Origin = Vector3(0.0f);       // The first sample at height zero.
+        Vector3 m_Scale = Vector3(1.0f);        // Sample spacing along x and y, height of one sample step along z.
+        float m_MinHeight = 0.0f;
+        float m_MaxHeight = 0.0f;
+
+        public:
+
+        HeightfieldCollider(size_t columns, size_t rows, std::vector<uint16_t> samples, const Vector3& scale);
+        HeightfieldCollider(size_t columns, size_t rows, const std::vector<float>& heights, const Vector3& scale);
+        ~HeightfieldCollider() = default;
+
+        size_t GetColumnCount() const;
+        size_t GetRowCount() const;
+        float GetHeight(size_t column, size_t row) const;
+        Matrix3 GetInertiaTensor(float mass) const;
+        inline Vector3 GetSupport(const Vector3& direction) const
+        {
+            return Vector3(
+                (direction.x >= 0) ? -m_Origin.x : m_Origin.x,
+                (direction.y >= 0) ? -m_Origin.y : m_Origin.y,
+                (direction.z >= 0) ? m_MaxHeight : m_MinHeight
+            );
+        }
+
+        // Calls visit(packet, count) with the two triangles of every cell under the bounds, given in the heightfield's space.
+        template <typename F>
+        void Query(const Bounds& bounds, F&& visit) const
+        {
+            if (bounds.max.z < m_MinHeight || bounds.min.z > m_MaxHeight) return;
+            float left = (bounds.min.x - m_Origin.x) / m_Scale.x;
+            float right = (bounds.max.x - m_Origin.x) / m_Scale.x;
+            float bottom = (bounds.min.y - m_Origin.y) / m_Scale.y;
+            float top = (bounds.max.y - m_Origin.y) / m_Scale.y;
+            // Written so bounds that aren't finite fail too, the cell range is then clamped while still in floats so the casts can't overflow.
+            float lastCellColumn = static_cast<float>(m_Columns - 2);
+            float lastCellRow = static_cast<float>(m_Rows - 2);
+            if (!(right >= 0.0f && top >= 0.0f && left < lastCellColumn + 1.0f && bottom < lastCellRow + 1.0f)) return;
+            size_t firstColumn = static_cast<size_t>(Clamp(left, 0.0f, lastCellColumn));
+            size_t lastColumn = static_cast<size_t>(Clamp(right, 0.0f, lastCellColumn));
+            size_t firstRow = static_cast<size_t>(Clamp(bottom, 0.0f, lastCellRow));
+            size_t lastRow = static_cast<size_t>(Clamp(top, 0.0f, lastCellRow));
+
+            // Cells entirely above or below the bounds are skipped on their samples alone.
+            const std::vector<uint16_t>& samples = *mp_Samples;
+            float low = (bounds.min.z - m_Origin.z) / m_Scale.z;
+            float high = (bounds.max.z - m_Origin.z) / m_Scale.z;
+            TriangleMeshCollider::TrianglePacket packet;
+            uint32_t count = 0;
+            auto add = [&](const Vector3& a, const Vector3& b, const Vector3& c)
+            {
+                for (size_t component = 0; component < 3; ++component)
+                {
+                    packet.vertices[0][component][count] = a[component];
+                    packet.vertices[1][component][count] = b[component];
+                    packet.vertices[2][component][count] = c[component];
+                }
+                if (++count < LaneCount) return;
+                visit(packet, count);
+                count = 0;
+            };
+            for (size_t row = firstRow; row <= lastRow; ++row)
+            {
+                for (size_t column = firstColumn; column <= lastColumn; ++column)
+                {
+                    size_t index = row * m_Columns + column;
+                    uint16_t corners[4] = { samples[index], samples[index + 1], samples[index + m_Columns], samples[index + m_Columns + 1] };
+                    if (std::max({ corners[0], corners[1], corners[2], corners[3] }) < low || std::min({ corners[0], corners[1], corners[2], corners[3] }) > high) continue;
+                    float x = m_Origin.x + static_cast<float>(column) * m_Scale.x;
+                    float y = m_Origin.y + static_cast<float>(row) * m_Scale.y;
+                    Vector3 a = Vector3(x, y, m_Origin.z + corners[0] * m_Scale.z);
+                    Vector3 b = Vector3(x + m_Scale.x, y, m_Origin.z + corners[1] * m_Scale.z);
+                    Vector3 c = Vector3(x, y + m_Scale.y, m_Origin.z + corners[2] * m_Scale.z);
+                    Vector3 d = Vector3(x + m_Scale.x, y + m_Scale.y, m_Origin.z + corners[3] * m_Scale.z);
+                    add(a, b, d);
+                    add(a, d, c);
+                }
+            }
+            if (count == 0) return;
+            for (size_t lane = count; lane < LaneCount; ++lane)
+            {
+                for (size_t vertex = 0; vertex < 3; ++vertex) for (size_t component = 0; component < 3; ++component) packet.vertices[vertex][component][lane] = packet.vertices[vertex][component][0];
+            }
+            visit(packet, count);
+        }
+
+    };
+
+    // Closed set of colliders stored by value, support queries dispatch on the shape without going through a vtable.
+    class ColliderVariant
+    {
+        private:
+
+        std::variant<CubeCollider, PlaneCollider, SphereCollider, CapsuleCollider, ConvexHullCollider, TriangleCollider, TriangleMeshCollider, HeightfieldCollider> m_Collider;
+
+        public:
+
+        ColliderVariant() = default;
+        template <ColliderConcept T>
+        ColliderVariant(T&& collider) : m_Collider(std::forward<T>(collider)) {}
+        ~ColliderVariant() = default;
+
+        template <ColliderConcept T>
+        inline const T& Get() const { return *std::get_if<T>(&m_Collider); }
+        inline Collider::Shape GetShape() const
+        {
+            switch (m_Collider.index())
+            {
+                case 0: return Collider::Shape::Cube;
+                case 1: return Collider::Shape::Plane;
+                case 2: return Collider::Shape::Sphere;
+                case 3: return Collider::Shape::Capsule;
+                case 4: return Collider::Shape::Mesh;
+                case 5: return Collider::Shape::Triangle;
+                case 6: return Collider::Shape::TriangleMesh;
+                case 7: return Collider::Shape::Heightfield;
+                default: return Collider::Shape::Unknown;
+            }
+        }
+        inline Vector3 GetSupport(const Vector3& direction) const
+        {
+            uint32_t hint = 0;
+            return GetSupport(direction, hint);
+        }
+        inline Vector3 GetSupport(const Vector3& direction, uint32_t& hint) const    // Only hulls use the hint, see ConvexHullCollider::GetSupport.
+        {
+            switch (m_Collider.index())
+            {
+                case 0: return Get<CubeCollider>().GetSupport(direction);
+                case 1: return Get<PlaneCollider>().GetSupport(direction);
+                case 2: return Get<SphereCollider>().GetSupport(direction);
+                case 3: return Get<CapsuleCollider>().GetSupport(direction);
+                case 4: return Get<ConvexHullCollider>().GetSupport(direction, hint);
+                case 5: return Get<TriangleCollider>().GetSupport(direction);
+                case 6: return Get<TriangleMeshCollider>().GetSupport(direction);
+                case 7: return Get<HeightfieldCollider>().GetSupport(direction);
+                default: return Vector3(0.0f);
+            }
+        }
+        inline bool IsStatic() const { return GetShape() == Collider::Shape::TriangleMesh || GetShape() == Collider::Shape::Heightfield; }    // Only bounds as support and no real inertia, these only go on stationary bodies.
+        inline Vector3 GetWorldSupport(const Frame& frame, const Vector3& direction) const { return frame.ToWorldPoint(GetSupport(frame.ToLocalNormal(direction))); }
+        inline Vector3 GetWorldSupport(const Frame& frame, const Vector3& direction, uint32_t& hint) const { return frame.ToWorldPoint(GetSupport(frame.ToLocalNormal(direction), hint)); }
+        Bounds GetWorldBounds(const Frame& frame) const;
+        Matrix3 GetInertiaTensor(float mass) const;
+        Matrix3 GetInverseInertiaTensor(float mass) const;
 
     };
 }
@@ -1,5 +1,6 @@
 #pragma once
-#include <memory>
+#include <limits>
+#include <stdexcept>
 #include <engine/core/math.hpp>
 #include <engine/core/collider.hpp>
 #include <engine/core/component.hpp>
@@ -16,37 +17,42 @@ namespace Engine
         float m_Restitution = 0.3f;
         float m_InverseMass = 1.0f;
         bool m_Stationary = false;
+        bool m_Sleeping = false;
+        bool m_Continuous = false;  // Swept along its motion when moving fast, so it can't pass through thin bodies.
+        float m_SleepTime = 0.0f;  // How long the body has been almost still.
         Vector3 m_Velocity = Vector3(0.0f);
         Vector3 m_ForceAccumulator = Vector3(0.0f);
         Vector3 m_AngularVelocity =  Vector3(0.0f);
         Vector3 m_TorqueAccumulator =  Vector3(0.0f);
         Matrix3 m_CachedInertiaTensor = Matrix3(1.0f);
         Matrix3 m_CachedInverseInertiaTensor = Matrix3(1.0f);
-        std::shared_ptr<Collider> m_Collider = nullptr;
+        ColliderVariant m_Collider;
 
         public:
 
         Physics() = default;
         template<ColliderConcept T>
-        Physics(T&& collider, bool stationary = false) : m_Collider(std::make_shared<T>(std::forward<T>(collider))), m_Stationary(stationary)
+        Physics(T&& collider, bool stationary = false) : m_Collider(std::forward<T>(collider)), m_Stationary(stationary)
         {
+            if (!m_Stationary && m_Collider.IsStatic()) throw std::runtime_error("Could not give static geometry to a moving body.");
             if (m_Stationary)
             {
                 m_Mass = std::numeric_limits<float>::infinity();
                 m_InverseMass = 0;
             }
-            m_CachedInertiaTensor = m_Collider->GetInertiaTensor(m_Mass);
+            m_CachedInertiaTensor = m_Collider.GetInertiaTensor(m_Mass);
             m_CachedInverseInertiaTensor = Inversed(m_CachedInertiaTensor);
         }
         template<ColliderConcept T>
-        Physics(T&& collider, float mass, bool stationary = false) : m_Collider(std::make_shared<T>(std::forward<T>(collider))), m_Mass(mass), m_InverseMass(1 / mass), m_Stationary(stationary)
+        Physics(T&& collider, float mass, bool stationary = false) : m_Collider(std::forward<T>(collider)), m_Mass(mass), m_InverseMass(1 / mass), m_Stationary(stationary)
         {
+            if (!m_Stationary && m_Collider.IsStatic()) throw std::runtime_error("Could not give static geometry to a moving body.");
             if (m_Stationary)
             {
                 m_Mass = std::numeric_limits<float>::infinity();
                 m_InverseMass = 0;
             }
-            m_CachedInertiaTensor = m_Collider->GetInertiaTensor(m_Mass);
+            m_CachedInertiaTensor = m_Collider.GetInertiaTensor(m_Mass);
             m_CachedInverseInertiaTensor = Inversed(m_CachedInertiaTensor);
         }
         ~Physics() = default;
@@ -66,10 +72,21 @@ namespace Engine
         void ApplyAngularImpulse(const Vector3& impulse, const Matrix3& worldInverseInertiaTensor);
         void Integrate(float deltaTime, const Matrix3& worldInverseInertiaTensor);
         void ResetAccumulators();
+        Vector3 GetAccumulatedForce() const;
+        Vector3 GetAccumulatedTorque() const;
         bool IsStationary() const;
-        Collider& GetCollider() const;
+        bool IsSleeping() const;
+        bool IsContinuous() const;
+        void SetContinuous(bool continuous);
+        void Sleep();
+        void Wake();
+        float GetSleepTime() const;
+        void SetSleepTime(float sleepTime);
+        const ColliderVariant& GetCollider() const;
         Vector3 GetVelocity() const;
+        void SetVelocity(const Vector3& velocity);
         Vector3 GetAngularVelocity() const;
+        void SetAngularVelocity(const Vector3& angularVelocity);
         Matrix3 GetInertiaTensor() const;
         Matrix3 GetInverseInertiaTensor() const;
 
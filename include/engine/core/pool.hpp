@@ -0,0 +1,56 @@
+#pragma once
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+#include <condition_variable>
+
+namespace Engine
+{
+    // Fixed set of worker threads for data parallel loops, the calling thread works on every loop too.
+    class ThreadPool
+    {
+        private:
+
+        using Task = void (*)(void* context, size_t begin, size_t end);
+
+        std::vector<std::thread> m_Workers;
+        std::mutex m_Mutex;
+        std::condition_variable m_Start;
+        std::condition_variable m_Done;
+        uint64_t m_Generation = 0;      // Bumped for every loop, wakes the workers.
+        size_t m_Active = 0;            // Workers that haven't finished the current loop.
+        bool m_Stopping = false;
+
+        Task mp_Task = nullptr;
+        void* mp_Context = nullptr;
+        size_t m_Count = 0;
+        size_t m_Grain = 1;
+        std::atomic<size_t> m_Next = 0;
+
+        void Work(size_t threadIndex);
+        void Drain();
+        void Run(Task task, void* context, size_t count, size_t grain);
+
+        public:
+
+        ThreadPool(size_t threadCount);
+        ThreadPool(const ThreadPool& other) = delete;
+        ThreadPool& operator=(const ThreadPool& other) = delete;
+        ~ThreadPool();
+
+        size_t GetThreadCount() const;
+        static size_t GetThreadIndex();     // Workers count from one, any other thread is zero.
+
+        // Calls function(begin, end) on blocks of at most grain indices out of [0, count), in any order and on any thread.
+        template <typename F>
+        void ParallelFor(size_t count, size_t grain, F&& function)
+        {
+            Task task = [](void* context, size_t begin, size_t end) { (*static_cast<std::remove_reference_t<F>*>(context))(begin, end); };
+            Run(task, const_cast<void*>(static_cast<const void*>(&function)), count, grain);
+        }
+
+    };
+}
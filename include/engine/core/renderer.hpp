@@ -31,7 +31,7 @@ namespace Engine
         Renderer();
         ~Renderer() = default;
 
-        void Render(World& world, Window& window);
+        void Render(World& world, Window& window, float alpha = 1.0f);
 
         private:
 
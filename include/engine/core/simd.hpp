@@ -0,0 +1,354 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace Engine
+{
+    // Floats processed side by side, eight with AVX2, four with SSE2 and a plain array of four otherwise, picked at compile time.
+    // Comparisons give masks with every lane all set or all clear, selects pick per lane between two values.
+    // Interleaved loads split LaneCount structs of three or four floats stored back to back into a lane set per member, the stores merge them back.
+
+#if defined(__AVX2__)
+
+    inline constexpr size_t LaneCount = 8;
+
+    struct MaskLanes
+    {
+        __m256 data;
+    };
+
+    struct FloatLanes
+    {
+        __m256 data;
+
+        inline FloatLanes() noexcept = default;
+        inline FloatLanes(__m256 data) noexcept : data(data) {}
+        inline FloatLanes(float scalar) noexcept : data(_mm256_set1_ps(scalar)) {}
+    };
+
+    inline FloatLanes Load(const float* values) noexcept { return _mm256_loadu_ps(values); }
+    inline void Store(float* values, const FloatLanes& lanes) noexcept { _mm256_storeu_ps(values, lanes.data); }
+    inline void LoadInterleaved(const float* values, FloatLanes& x, FloatLanes& y, FloatLanes& z) noexcept
+    {
+        // Each half transposes four triples, the low half the first four and the high half the rest.
+        __m256 first = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(values)), _mm_loadu_ps(values + 12), 1);
+        __m256 second = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(values + 4)), _mm_loadu_ps(values + 16), 1);
+        __m256 third = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(values + 8)), _mm_loadu_ps(values + 20), 1);
+        __m256 xy = _mm256_shuffle_ps(second, third, _MM_SHUFFLE(2, 1, 3, 2));
+        __m256 yz = _mm256_shuffle_ps(first, second, _MM_SHUFFLE(1, 0, 2, 1));
+        x = _mm256_shuffle_ps(first, xy, _MM_SHUFFLE(2, 0, 3, 0));
+        y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+        z = _mm256_shuffle_ps(yz, third, _MM_SHUFFLE(3, 0, 3, 1));
+    }
+    inline void StoreInterleaved(float* values, const FloatLanes& x, const FloatLanes& y, const FloatLanes& z) noexcept
+    {
+        __m256 xy = _mm256_shuffle_ps(x.data, y.data, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 yz = _mm256_shuffle_ps(y.data, z.data, _MM_SHUFFLE(3, 1, 3, 1));
+        __m256 zx = _mm256_shuffle_ps(z.data, x.data, _MM_SHUFFLE(3, 1, 2, 0));
+        __m256 first = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 second = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+        __m256 third = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(values, _mm256_castps256_ps128(first));
+        _mm_storeu_ps(values + 4, _mm256_castps256_ps128(second));
+        _mm_storeu_ps(values + 8, _mm256_castps256_ps128(third));
+        _mm_storeu_ps(values + 12, _mm256_extractf128_ps(first, 1));
+        _mm_storeu_ps(values + 16, _mm256_extractf128_ps(second, 1));
+        _mm_storeu_ps(values + 20, _mm256_extractf128_ps(third, 1));
+    }
+    inline void LoadInterleaved(const float* values, FloatLanes& a, FloatLanes& b, FloatLanes& c, FloatLanes& d) noexcept
+    {
+        __m256 first = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(values)), _mm_loadu_ps(values + 16), 1);
+        __m256 second = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(values + 4)), _mm_loadu_ps(values + 20), 1);
+        __m256 third = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(values + 8)), _mm_loadu_ps(values + 24), 1);
+        __m256 fourth = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(values + 12)), _mm_loadu_ps(values + 28), 1);
+        __m256 low = _mm256_unpacklo_ps(first, second);
+        __m256 high = _mm256_unpackhi_ps(first, second);
+        __m256 lowNext = _mm256_unpacklo_ps(third, fourth);
+        __m256 highNext = _mm256_unpackhi_ps(third, fourth);
+        a = _mm256_shuffle_ps(low, lowNext, _MM_SHUFFLE(1, 0, 1, 0));
+        b = _mm256_shuffle_ps(low, lowNext, _MM_SHUFFLE(3, 2, 3, 2));
+        c = _mm256_shuffle_ps(high, highNext, _MM_SHUFFLE(1, 0, 1, 0));
+        d = _mm256_shuffle_ps(high, highNext, _MM_SHUFFLE(3, 2, 3, 2));
+    }
+    inline void StoreInterleaved(float* values, const FloatLanes& a, const FloatLanes& b, const FloatLanes& c, const FloatLanes& d) noexcept
+    {
+        __m256 low = _mm256_unpacklo_ps(a.data, b.data);
+        __m256 high = _mm256_unpackhi_ps(a.data, b.data);
+        __m256 lowNext = _mm256_unpacklo_ps(c.data, d.data);
+        __m256 highNext = _mm256_unpackhi_ps(c.data, d.data);
+        __m256 first = _mm256_shuffle_ps(low, lowNext, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 second = _mm256_shuffle_ps(low, lowNext, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 third = _mm256_shuffle_ps(high, highNext, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 fourth = _mm256_shuffle_ps(high, highNext, _MM_SHUFFLE(3, 2, 3, 2));
+        _mm_storeu_ps(values, _mm256_castps256_ps128(first));
+        _mm_storeu_ps(values + 4, _mm256_castps256_ps128(second));
+        _mm_storeu_ps(values + 8, _mm256_castps256_ps128(third));
+        _mm_storeu_ps(values + 12, _mm256_castps256_ps128(fourth));
+        _mm_storeu_ps(values + 16, _mm256_extractf128_ps(first, 1));
+        _mm_storeu_ps(values + 20, _mm256_extractf128_ps(second, 1));
+        _mm_storeu_ps(values + 24, _mm256_extractf128_ps(third, 1));
+        _mm_storeu_ps(values + 28, _mm256_extractf128_ps(fourth, 1));
+    }
+    inline FloatLanes operator+(const FloatLanes& a, const FloatLanes& b) noexcept { return _mm256_add_ps(a.data, b.data); }
+    inline FloatLanes operator-(const FloatLanes& a, const FloatLanes& b) noexcept { return _mm256_sub_ps(a.data, b.data); }
+    inline FloatLanes operator*(const FloatLanes& a, const FloatLanes& b) noexcept { return _mm256_mul_ps(a.data, b.data); }
+    inline FloatLanes operator/(const FloatLanes& a, const FloatLanes& b) noexcept { return _mm256_div_ps(a.data, b.data); }
+    inline FloatLanes operator-(const FloatLanes& a) noexcept { return _mm256_xor_ps(a.data, _mm256_set1_ps(-0.0f)); }
+    inline MaskLanes operator<(const FloatLanes& a, const FloatLanes& b) noexcept { return { _mm256_cmp_ps(a.data, b.data, _CMP_LT_OQ) }; }
+    inline MaskLanes operator>(const FloatLanes& a, const FloatLanes& b) noexcept { return { _mm256_cmp_ps(a.data, b.data, _CMP_GT_OQ) }; }
+    inline MaskLanes operator>=(const FloatLanes& a, const FloatLanes& b) noexcept { return { _mm256_cmp_ps(a.data, b.data, _CMP_GE_OQ) }; }
+    inline MaskLanes operator==(const FloatLanes& a, const FloatLanes& b) noexcept { return { _mm256_cmp_ps(a.data, b.data, _CMP_EQ_OQ) }; }
+    inline MaskLanes operator&(const MaskLanes& a, const MaskLanes& b) noexcept { return { _mm256_and_ps(a.data, b.data) }; }
+    inline MaskLanes operator|(const MaskLanes& a, const MaskLanes& b) noexcept { return { _mm256_or_ps(a.data, b.data) }; }
+    inline MaskLanes AndNot(const MaskLanes& a, const MaskLanes& b) noexcept { return { _mm256_andnot_ps(b.data, a.data) }; }
+    inline FloatLanes Select(const MaskLanes& mask, const FloatLanes& ifTrue, const FloatLanes& ifFalse) noexcept { return _mm256_blendv_ps(ifFalse.data, ifTrue.data, mask.data); }
+    inline FloatLanes SquareRoot(const FloatLanes& a) noexcept { return _mm256_sqrt_ps(a.data); }
+    inline FloatLanes Max(const FloatLanes& a, const FloatLanes& b) noexcept { return _mm256_max_ps(a.data, b.data); }
+    inline uint32_t ToBits(const MaskLanes& mask) noexcept { return static_cast<uint32_t>(_mm256_movemask_ps(mask.data)); }
+    inline MaskLanes FromBits(uint32_t bits) noexcept
+    {
+        __m256i lanes = _mm256_and_si256(_mm256_set1_epi32(static_cast<int>(bits)), _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128));
+        return { _mm256_castsi256_ps(_mm256_cmpeq_epi32(lanes, _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128))) };
+    }
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+    inline constexpr size_t LaneCount = 4;
+
+    struct MaskLanes
+    {
+        __m128 data;
+    };
+
+    struct FloatLanes
+    {
+        __m128 data;
+
+        inline FloatLanes() noexcept = default;
+        inline FloatLanes(__m128 data) noexcept : data(data) {}
+        inline FloatLanes(float scalar) noexcept : data(_mm_set1_ps(scalar)) {}
+    };
+
+    inline FloatLanes Load(const float* values) noexcept { return _mm_loadu_ps(values); }
+    inline void Store(float* values, const FloatLanes& lanes) noexcept { _mm_storeu_ps(values, lanes.data); }
+    inline void LoadInterleaved(const float* values, FloatLanes& x, FloatLanes& y, FloatLanes& z) noexcept
+    {
+        __m128 first = _mm_loadu_ps(values);
+        __m128 second = _mm_loadu_ps(values + 4);
+        __m128 third = _mm_loadu_ps(values + 8);
+        __m128 xy = _mm_shuffle_ps(second, third, _MM_SHUFFLE(2, 1, 3, 2));
+        __m128 yz = _mm_shuffle_ps(first, second, _MM_SHUFFLE(1, 0, 2, 1));
+        x = _mm_shuffle_ps(first, xy, _MM_SHUFFLE(2, 0, 3, 0));
+        y = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+        z = _mm_shuffle_ps(yz, third, _MM_SHUFFLE(3, 0, 3, 1));
+    }
+    inline void StoreInterleaved(float* values, const FloatLanes& x, const FloatLanes& y, const FloatLanes& z) noexcept
+    {
+        __m128 xy = _mm_shuffle_ps(x.data, y.data, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 yz = _mm_shuffle_ps(y.data, z.data, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 zx = _mm_shuffle_ps(z.data, x.data, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_ps(values, _mm_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(values + 4, _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0)));
+        _mm_storeu_ps(values + 8, _mm_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    inline void LoadInterleaved(const float* values, FloatLanes& a, FloatLanes& b, FloatLanes& c, FloatLanes& d) noexcept
+    {
+        __m128 first = _mm_loadu_ps(values);
+        __m128 second = _mm_loadu_ps(values + 4);
+        __m128 third = _mm_loadu_ps(values + 8);
+        __m128 fourth = _mm_loadu_ps(values + 12);
+        _MM_TRANSPOSE4_PS(first, second, third, fourth);
+        a = first;
+        b = second;
+        c = third;
+        d = fourth;
+    }
+    inline void StoreInterleaved(float* values, const FloatLanes& a, const FloatLanes& b, const FloatLanes& c, const FloatLanes& d) noexcept
+    {
+        __m128 first = a.data;
+        __m128 second = b.data;
+        __m128 third = c.data;
+        __m128 fourth = d.data;
+        _MM_TRANSPOSE4_PS(first, second, third, fourth);
+        _mm_storeu_ps(values, first);
+        _mm_storeu_ps(values + 4, second);
+        _mm_storeu_ps(values + 8, third);
+        _mm_storeu_ps(values + 12, fourth);
+    }
+    inline FloatLanes operator+(const FloatLanes& a, const FloatLanes& b) noexcept { return _mm_add_ps(a.data, b.data); }
+    inline FloatLanes operator-(const FloatLanes& a, const FloatLanes& b) noexcept { return _mm_sub_ps(a.data, b.data); }
+    inline FloatLanes operator*(const FloatLanes& a, const FloatLanes& b) noexcept { return _mm_mul_ps(a.data, b.data); }
+    inline FloatLanes operator/(const FloatLanes& a, const FloatLanes& b) noexcept { return _mm_div_ps(a.data, b.data); }
+    inline FloatLanes operator-(const FloatLanes& a) noexcept { return _mm_xor_ps(a.data, _mm_set1_ps(-0.0f)); }
+    inline MaskLanes operator<(const FloatLanes& a, const FloatLanes& b) noexcept { return { _mm_cmplt_ps(a.data, b.data) }; }
+    inline MaskLanes operator>(const FloatLanes& a, const FloatLanes& b) noexcept { return { _mm_cmpgt_ps(a.data, b.data) }; }
+    inline MaskLanes operator>=(const FloatLanes& a, const FloatLanes& b) noexcept { return { _mm_cmpge_ps(a.data, b.data) }; }
+    inline MaskLanes operator==(const FloatLanes& a, const FloatLanes& b) noexcept { return { _mm_cmpeq_ps(a.data, b.data) }; }
+    inline MaskLanes operator&(const MaskLanes& a, const MaskLanes& b) noexcept { return { _mm_and_ps(a.data, b.data) }; }
+    inline MaskLanes operator|(const MaskLanes& a, const MaskLanes& b) noexcept { return { _mm_or_ps(a.data, b.data) }; }
+    inline MaskLanes AndNot(const MaskLanes& a, const MaskLanes& b) noexcept { return { _mm_andnot_ps(b.data, a.data) }; }
+    inline FloatLanes Select(const MaskLanes& mask, const FloatLanes& ifTrue, const FloatLanes& ifFalse) noexcept { return _mm_or_ps(_mm_and_ps(mask.data, ifTrue.data), _mm_andnot_ps(mask.data, ifFalse.data)); }
+    inline FloatLanes SquareRoot(const FloatLanes& a) noexcept { return _mm_sqrt_ps(a.data); }
+    inline FloatLanes Max(const FloatLanes& a, const FloatLanes& b) noexcept { return _mm_max_ps(a.data, b.data); }
+    inline uint32_t ToBits(const MaskLanes& mask) noexcept { return static_cast<uint32_t>(_mm_movemask_ps(mask.data)); }
+    inline MaskLanes FromBits(uint32_t bits) noexcept
+    {
+        __m128i lanes = _mm_and_si128(_mm_set1_epi32(static_cast<int>(bits)), _mm_setr_epi32(1, 2, 4, 8));
+        return { _mm_castsi128_ps(_mm_cmpeq_epi32(lanes, _mm_setr_epi32(1, 2, 4, 8))) };
+    }
+
+#else
+
+    inline constexpr size_t LaneCount = 4;
+
+    struct MaskLanes
+    {
+        std::array<bool, LaneCount> data;
+    };
+
+    struct FloatLanes
+    {
+        std::array<float, LaneCount> data;
+
+        inline FloatLanes() noexcept = default;
+        inline FloatLanes(float scalar) noexcept { data.fill(scalar); }
+    };
+
+    template <typename F>
+    inline FloatLanes Transformed(const FloatLanes& a, const FloatLanes& b, F function) noexcept
+    {
+        FloatLanes result;
+        for (size_t lane = 0; lane < LaneCount; ++lane) result.data[lane] = function(a.data[lane], b.data[lane]);
+        return result;
+    }
+    template <typename F>
+    inline MaskLanes Compared(const FloatLanes& a, const FloatLanes& b, F function) noexcept
+    {
+        MaskLanes result;
+        for (size_t lane = 0; lane < LaneCount; ++lane) result.data[lane] = function(a.data[lane], b.data[lane]);
+        return result;
+    }
+    inline FloatLanes Load(const float* values) noexcept
+    {
+        FloatLanes result;
+        for (size_t lane = 0; lane < LaneCount; ++lane) result.data[lane] = values[lane];
+        return result;
+    }
+    inline void Store(float* values, const FloatLanes& lanes) noexcept { for (size_t lane = 0; lane < LaneCount; ++lane) values[lane] = lanes.data[lane]; }
+    inline void LoadInterleaved(const float* values, FloatLanes& x, FloatLanes& y, FloatLanes& z) noexcept
+    {
+        for (size_t lane = 0; lane < LaneCount; ++lane)
+        {
+            x.data[lane] = values[3 * lane];
+            y.data[lane] = values[3 * lane + 1];
+            z.data[lane] = values[3 * lane + 2];
+        }
+    }
+    inline void StoreInterleaved(float* values, const FloatLanes& x, const FloatLanes& y, const FloatLanes& z) noexcept
+    {
+        for (size_t lane = 0; lane < LaneCount; ++lane)
+        {
+            values[3 * lane] = x.data[lane];
+            values[3 * lane + 1] = y.data[lane];
+            values[3 * lane + 2] = z.data[lane];
+        }
+    }
+    inline void LoadInterleaved(const float* values, FloatLanes& a, FloatLanes& b, FloatLanes& c, FloatLanes& d) noexcept
+    {
+        for (size_t lane = 0; lane < LaneCount; ++lane)
+        {
+            a.data[lane] = values[4 * lane];
+            b.data[lane] = values[4 * lane + 1];
+            c.data[lane] = values[4 * lane + 2];
+            d.data[lane] = values[4 * lane + 3];
+        }
+    }
+    inline void StoreInterleaved(float* values, const FloatLanes& a, const FloatLanes& b, const FloatLanes& c, const FloatLanes& d) noexcept
+    {
+        for (size_t lane = 0; lane < LaneCount; ++lane)
+        {
+            values[4 * lane] = a.data[lane];
+            values[4 * lane + 1] = b.data[lane];
+            values[4 * lane + 2] = c.data[lane];
+            values[4 * lane + 3] = d.data[lane];
+        }
+    }
+    inline FloatLanes operator+(const FloatLanes& a, const FloatLanes& b) noexcept { return Transformed(a, b, [](float x, float y) { return x + y; }); }
+    inline FloatLanes operator-(const FloatLanes& a, const FloatLanes& b) noexcept { return Transformed(a, b, [](float x, float y) { return x - y; }); }
+    inline FloatLanes operator*(const FloatLanes& a, const FloatLanes& b) noexcept { return Transformed(a, b, [](float x, float y) { return x * y; }); }
+    inline FloatLanes operator/(const FloatLanes& a, const FloatLanes& b) noexcept { return Transformed(a, b, [](float x, float y) { return x / y; }); }
+    inline FloatLanes operator-(const FloatLanes& a) noexcept { return Transformed(a, a, [](float x, float) { return -x; }); }
+    inline MaskLanes operator<(const FloatLanes& a, const FloatLanes& b) noexcept { return Compared(a, b, [](float x, float y) { return x < y; }); }
+    inline MaskLanes operator>(const FloatLanes& a, const FloatLanes& b) noexcept { return Compared(a, b, [](float x, float y) { return x > y; }); }
+    inline MaskLanes operator>=(const FloatLanes& a, const FloatLanes& b) noexcept { return Compared(a, b, [](float x, float y) { return x >= y; }); }
+    inline MaskLanes operator==(const FloatLanes& a, const FloatLanes& b) noexcept { return Compared(a, b, [](float x, float y) { return x == y; }); }
+    inline MaskLanes operator&(const MaskLanes& a, const MaskLanes& b) noexcept
+    {
+        MaskLanes result;
+        for (size_t lane = 0; lane < LaneCount; ++lane) result.data[lane] = a.data[lane] && b.data[lane];
+        return result;
+    }
+    inline MaskLanes operator|(const MaskLanes& a, const MaskLanes& b) noexcept
+    {
+        MaskLanes result;
+        for (size_t lane = 0; lane < LaneCount; ++lane) result.data[lane] = a.data[lane] || b.data[lane];
+        return result;
+    }
+    inline MaskLanes AndNot(const MaskLanes& a, const MaskLanes& b) noexcept
+    {
+        MaskLanes result;
+        for (size_t lane = 0; lane < LaneCount; ++lane) result.data[lane] = a.data[lane] && !b.data[lane];
+        return result;
+    }
+    inline FloatLanes Select(const MaskLanes& mask, const FloatLanes& ifTrue, const FloatLanes& ifFalse) noexcept
+    {
+        FloatLanes result;
+        for (size_t lane = 0; lane < LaneCount; ++lane) result.data[lane] = mask.data[lane] ? ifTrue.data[lane] : ifFalse.data[lane];
+        return result;
+    }
+    inline FloatLanes SquareRoot(const FloatLanes& a) noexcept { return Transformed(a, a, [](float x, float) { return std::sqrt(x); }); }
+    inline FloatLanes Max(const FloatLanes& a, const FloatLanes& b) noexcept { return Transformed(a, b, [](float x, float y) { return x > y ? x : y; }); }
+    inline uint32_t ToBits(const MaskLanes& mask) noexcept
+    {
+        uint32_t bits = 0;
+        for (size_t lane = 0; lane < LaneCount; ++lane) bits |= static_cast<uint32_t>(mask.data[lane]) << lane;
+        return bits;
+    }
+    inline MaskLanes FromBits(uint32_t bits) noexcept
+    {
+        MaskLanes result;
+        for (size_t lane = 0; lane < LaneCount; ++lane) result.data[lane] = (bits >> lane) & 1;
+        return result;
+    }
+
+#endif
+
+    inline bool Any(const MaskLanes& mask) noexcept { return ToBits(mask) != 0; }
+    inline MaskLanes operator<=(const FloatLanes& a, const FloatLanes& b) noexcept { return b >= a; }
+
+    struct Vector3Lanes
+    {
+        FloatLanes x;
+        FloatLanes y;
+        FloatLanes z;
+    };
+
+    inline Vector3Lanes operator+(const Vector3Lanes& a, const Vector3Lanes& b) noexcept { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+    inline Vector3Lanes operator-(const Vector3Lanes& a, const Vector3Lanes& b) noexcept { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    inline Vector3Lanes operator*(const Vector3Lanes& a, const FloatLanes& b) noexcept { return { a.x * b, a.y * b, a.z * b }; }
+    inline Vector3Lanes operator-(const Vector3Lanes& a) noexcept { return { -a.x, -a.y, -a.z }; }
+    inline FloatLanes Dot(const Vector3Lanes& a, const Vector3Lanes& b) noexcept { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    inline FloatLanes LengthSquared(const Vector3Lanes& a) noexcept { return Dot(a, a); }
+    inline Vector3Lanes Cross(const Vector3Lanes& a, const Vector3Lanes& b) noexcept { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+    inline Vector3Lanes Select(const MaskLanes& mask, const Vector3Lanes& ifTrue, const Vector3Lanes& ifFalse) noexcept
+    {
+        return { Select(mask, ifTrue.x, ifFalse.x), Select(mask, ifTrue.y, ifFalse.y), Select(mask, ifTrue.z, ifFalse.z) };
+    }
+}
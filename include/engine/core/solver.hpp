@@ -1,14 +1,55 @@
 #pragma once
+#include <array>
+#include <bitset>
+#include <memory>
+#include <vector>
 #include <engine/core/math.hpp>
+#include <engine/core/pool.hpp>
+#include <engine/core/simd.hpp>
 #include <engine/core/world.hpp>
 #include <engine/core/physics.hpp>
 #include <engine/core/collider.hpp>
 #include <engine/core/transform.hpp>
+#include <engine/core/broadphase.hpp>
 
 namespace Engine
 {
     class Solver
     {
+        public:
+
+        struct Statistics
+        {
+            size_t gjkQueries = 0;              // GJK runs this step.
+            size_t gjkCacheHits = 0;            // Runs seeded from the pair cache.
+            size_t gjkIterations = 0;           // Simplex refinements over all runs, an immediate exit counts none.
+            size_t gjkBatchedPairs = 0;         // GJK pairs screened by the batched overlap test first.
+            size_t gjkBatchedSeparations = 0;   // Screened pairs found apart, they skip the scalar GJK.
+            float gjkHitRate = 0.0f;
+            float gjkAverageIterations = 0.0f;
+            size_t epaQueries = 0;
+            size_t epaIterations = 0;
+            float epaAverageIterations = 0.0f;
+            size_t narrowphasePairs = 0;        // Pairs tested this step, sleeping and stationary ones are skipped.
+            float narrowphaseTime = 0.0f;       // Seconds spent in collision tests and manifold updates.
+            size_t contacts = 0;                // Contact rows handed to the constraint solver.
+            size_t islands = 0;                 // Groups of touching bodies that are awake.
+            size_t sleepingBodies = 0;
+            size_t coloredIslands = 0;          // Islands large enough to be split by color across threads.
+            size_t colors = 0;                  // Colors over all colored islands.
+            size_t continuousBodies = 0;        // Fast continuous bodies swept along their motion this step.
+            size_t continuousClamps = 0;        // Swept bodies moved back to where they first touched something.
+            size_t matrixProducts = 0;          // 3x3 matrix products, two for each world inverse inertia tensor, built once per moving body.
+            size_t meshTriangles = 0;           // Triangles in mesh leaves and heightfield cells under a body's bounds, screened a packet at a time.
+            size_t meshTriangleTests = 0;       // Triangles left by the screen and tested exactly.
+        };
+
+        enum class EPAMode
+        {
+            LinearScan,     // Scans every face for the closest one and the horizon, cheapest on the small polytopes of boxes and planes.
+            Heap,           // Keeps faces in a binary heap and walks the horizon through a hashed edge map, scales to rounded shapes.
+        };
+
         private:
 
         struct Support
@@ -37,6 +78,25 @@ namespace Engine
 
         };
 
+        // Fixed capacity vector on the stack, keeps the narrowphase free of heap allocations.
+        template <typename T, size_t Capacity>
+        struct Buffer
+        {
+            std::array<T, Capacity> data;
+            size_t count = 0;
+
+            bool IsFull() const { return count == Capacity; }
+            size_t size() const { return count; }
+            void clear() { count = 0; }
+            void push_back(const T& value) { data[count++] = value; }
+            void pop_back() { --count; }
+            T& back() { return data[count - 1]; }
+            T& operator[](size_t index) { return data[index]; }
+            const T& operator[](size_t index) const { return data[index]; }
+            T* begin() { return data.data(); }
+            T* end() { return data.data() + count; }
+        };
+
         struct Face
         {
             size_t a;
@@ -44,14 +104,25 @@ namespace Engine
             size_t c;
             Vector3 normal;
             float distance;
+            bool removed;
 
-            Face(size_t a, size_t b, size_t c, const std::vector<Support>& polytope) : a(a), b(b), c(c)
+            Face() = default;
+            Face(size_t a, size_t b, size_t c, const Support* polytope) : a(a), b(b), c(c), removed(false)
             {
                 normal = Normalized(Cross(polytope[b].point - polytope[a].point, polytope[c].point - polytope[a].point));
                 distance = Dot(normal, polytope[a].point);
             }
         };
 
+        static constexpr size_t s_MaxContacts = 4;
+        static constexpr float s_ContactBreakingDistance = 0.02f;  // Cached points that drift or separate further than this are dropped.
+
+        struct Contact
+        {
+            Vector3 pointA;     // Furthest point of A into B.
+            Vector3 pointB;     // Furthest point of B into A.
+        };
+
         struct CollisionInfo
         {
             enum class Status
@@ -63,34 +134,372 @@ namespace Engine
             };
 
             Status status;
-            Vector3 contactPointA; // Furthest point of A into B.
-            Vector3 contactPointB; // Furthest point of B into A.
+            std::array<Contact, s_MaxContacts> contacts;   // The deepest contact comes first.
+            size_t contactCount = 0;
             Vector3 normal;
             float depth;
 
             operator bool() { return status == Status::Colliding; }
+            void AddContact(const Vector3& pointA, const Vector3& pointB) { contacts[contactCount++] = { pointA, pointB }; }
+        };
+
+        struct ManifoldPoint
+        {
+            Vector3 localPointA;    // Kept in body space so the point follows both bodies from step to step.
+            Vector3 localPointB;
+            Vector3 pointA;
+            Vector3 pointB;
+            float depth;
+            float normalImpulse = 0.0f;                 // Accumulated impulses of the last step, warm start the next one.
+            Vector3 tangentImpulse = Vector3(0.0f);     // Kept in world space, the friction axes are rebuilt every step.
+        };
+
+        struct Manifold
+        {
+            std::array<ManifoldPoint, s_MaxContacts> points;
+            size_t count = 0;
+            Vector3 normal;
+        };
+
+        struct Box
+        {
+            Vector3 center;
+            Vector3 axes[3];
+            Vector3 halfExtents;
+        };
+
+        struct Capsule
+        {
+            Vector3 center;
+            Vector3 axis;       // The segment runs half the length either way along it.
+            float halfLength;
+            float radius;
+        };
+
+        static constexpr size_t s_ShapeCount = static_cast<size_t>(Collider::Shape::Mesh) + 1;
+        using CollisionTest = CollisionInfo (Solver::*)(const ColliderVariant&, const Frame&, const ColliderVariant&, const Frame&);
+        using CollisionTable = std::array<std::array<CollisionTest, s_ShapeCount>, s_ShapeCount>;
+
+        // Vertices the last support queries on each shape of a pair ended on, hull climbs start from them. Other shapes leave them alone.
+        struct SupportHints
+        {
+            uint32_t a = 0;
+            uint32_t b = 0;
+        };
+
+        // Per pair state kept between steps.
+        struct PairCache
+        {
+            uint64_t key;           // Entity ids of both bodies, the lower one in the high bits.
+            uint32_t stamp = 0;     // Entries not stamped with the current step are empty.
+            Vector3 direction;      // Last GJK search direction.
+            Manifold manifold;
+            SupportHints hints;
+        };
+
+        struct Body
+        {
+            Handle handle;
+            Transform* transform;
+            Physics* physics;
+            Frame frame;                // Pose at the start of the step, used by the narrowphase.
+            bool continuous;            // Moving far enough this step to be swept, its proxy covers the whole motion.
+        };
+
+        // What integration and the constraint solver work on, one entry per body and stored field by field so integration streams through contiguous arrays.
+        // Loaded from the components at the start of the step and written back at the end.
+        struct BodyStates
+        {
+            std::vector<Vector3> position;
+            std::vector<Quaternion> orientation;
+            std::vector<Vector3> velocity;
+            std::vector<Vector3> angularVelocity;
+            std::vector<Vector3> acceleration;          // From the accumulated force plus gravity and the torque, fixed for the step so every substep applies its share.
+            std::vector<Vector3> angularAcceleration;
+            std::vector<float> inverseMass;         // Zero for stationary and sleeping bodies, like the rest of what integration reads.
+            std::vector<Matrix3> inverseInertia;    // World space, built once per step and read by every contact of the body.
+            std::vector<float> drag;
+            std::vector<float> moving;              // One for bodies the step moves, zero for the rest, integration scales by it instead of branching.
+
+            size_t size() const { return position.size(); }
+            void resize(size_t count);
+        };
+
+        struct ContactManifold
+        {
+            uint32_t bodyA;
+            uint32_t bodyB;
+            Manifold* manifold;         // Lives in the pair cache, which doesn't move during a step.
+            uint32_t island;
+            uint32_t color;
+        };
+
+        struct NarrowphasePair
+        {
+            uint32_t bodyA;
+            uint32_t bodyB;
+            PairCache* cache;           // Created up front, each pair only writes its own entry.
+            bool cached;
+        };
+
+        // Spheres, cubes and planes all reduce to boxes rounded by a radius and mapped by their frame, a sphere has no extents and a plane no thickness.
+        // Stored one lane per shape, the batched GJK fills a lane per pair and the triangle screen every lane with the same body to test a packet of triangles against it.
+        struct RoundedBoxes
+        {
+            float position[3][LaneCount];
+            float linear[3][3][LaneCount];      // Column, then component.
+            float halfExtents[3][LaneCount];    // Local space, like the radius.
+            float radius[LaneCount];
+        };
+
+        struct GJKBatch
+        {
+            RoundedBoxes a;
+            RoundedBoxes b;
+            float direction[3][LaneCount];      // Seeded like the scalar GJK, the last search direction is written back.
+            float simplex[4][2][3][LaneCount];  // Final tetrahedron of lanes that contain the origin, difference points and the points on A.
+            uint32_t pairs[LaneCount];          // Narrowphase pair of every lane.
+            uint32_t contained;                 // Lanes ending in a tetrahedron around the origin, ready for EPA.
+            size_t count = 0;
+        };
+
+        // Filled by one thread at a time during the narrowphase, merged in pair order afterwards.
+        struct alignas(64) NarrowphaseBuffer
+        {
+            std::vector<uint32_t> touching;     // Narrowphase pairs whose manifold isn't empty.
+            Statistics statistics;
+        };
+
+        // Manifolds of an island only touch its own bodies and stationary ones, so islands can be solved concurrently.
+        struct Island
+        {
+            uint32_t firstManifold;     // Range in the manifold list, which is sorted by island.
+            uint32_t manifoldCount;
+            uint32_t firstColor;        // Range in the color offsets.
+            uint32_t colorCount;        // Zero for islands solved whole on one thread.
+        };
+
+        // One row per manifold point, stored field by field so the solver iterations stream through contiguous arrays.
+        struct ContactConstraints
+        {
+            std::vector<uint32_t> bodyA;
+            std::vector<uint32_t> bodyB;
+            std::vector<Vector3> normal;
+            std::vector<Vector3> tangentU;
+            std::vector<Vector3> tangentV;
+            std::vector<Vector3> relativeA;         // Contact points from the center of each body.
+            std::vector<Vector3> relativeB;
+            std::vector<Vector3> anchorA;           // Contact points in each body's rotated frame, followed by the position iterations.
+            std::vector<Vector3> anchorB;
+            std::vector<float> normalMass;
+            std::vector<float> tangentMassU;
+            std::vector<float> tangentMassV;
+            std::vector<float> normalImpulse;       // Accumulated over the iterations.
+            std::vector<float> tangentImpulseU;
+            std::vector<float> tangentImpulseV;
+            std::vector<float> bias;                // Restitution target for the normal velocity.
+            std::vector<float> friction;
+            std::vector<ManifoldPoint*> points;     // Where the impulses are written back for the next step.
+
+            size_t size() const { return bodyA.size(); }
+            void resize(size_t count);
         };
 
         float m_Gravity = 9.81f;
+        float m_FixedTimeStep = 1.0f / 60.0f;
+        size_t m_MaxSteps = 4;             // Per call to Simulate, slow frames drop the time beyond this instead of falling further behind.
+        size_t m_Substeps = 1;             // Integration and contact solving passes per Solve, each over an equal share of the step.
+        float m_Accumulator = 0.0f;        // Frame time not yet simulated, always under one fixed step after Simulate.
+        EPAMode m_EPAMode = EPAMode::LinearScan;
+        size_t m_VelocityIterations = 8;
+        size_t m_PositionIterations = 3;
+        bool m_SleepEnabled = true;
+        bool m_BatchedGJKEnabled = true;           // Off sends every pair through the scalar tests, the reference the batched screen is measured against.
+        bool m_BatchedIntegrationEnabled = true;   // Off integrates every body one at a time, the reference the lanes are tested against.
+        std::unique_ptr<Broadphase> mp_Broadphase = std::make_unique<SweepAndPrune>();
+        std::vector<Body> m_Bodies;
+        BodyStates m_States;
+        std::vector<Broadphase::Proxy> m_Proxies;
+        std::vector<Broadphase::Pair> m_Pairs;
+        std::vector<PairCache> m_PairCache;             // Open addressed with linear probing, power of two capacity.
+        std::vector<PairCache> m_PreviousPairCache;     // Last step's table, pairs that stopped overlapping just aren't carried over.
+        uint32_t m_Stamp = 1;
+        std::vector<NarrowphasePair> m_NarrowphasePairs;
+        std::vector<NarrowphaseBuffer> m_NarrowphaseBuffers = std::vector<NarrowphaseBuffer>(1);     // One per thread.
+        std::vector<uint32_t> m_Touching;
+        std::vector<ContactManifold> m_Manifolds;
+        std::vector<ContactManifold> m_SortedManifolds;
+        std::vector<uint32_t> m_ManifoldRows;          // First contact row of every manifold, closed by the row count.
+        std::vector<Island> m_Islands;
+        std::vector<uint32_t> m_IslandOffsets;
+        std::vector<uint32_t> m_ColorOffsets;          // Manifold index each color of a colored island starts at, closed by the island's end.
+        std::vector<uint64_t> m_BodyColors;            // Colors already taken around each body while coloring an island.
+        std::unique_ptr<ThreadPool> mp_ThreadPool;     // Null when solving on the calling thread only.
+        ContactConstraints m_Contacts;
+        std::vector<uint32_t> m_IslandParents;     // Union-find forest over body indices, linked by touching pairs.
+        std::vector<float> m_IslandSleepTimes;
+        std::vector<float> m_TimesOfImpact;        // Fraction of the step each swept body gets to move.
+        Statistics m_Statistics;
+
+        static constexpr float s_RestitutionThreshold = 1.0f;      // Slower approaches don't bounce, keeps resting contacts from chattering.
+        static constexpr float s_LinearSlop = 0.005f;              // Penetration the position iterations leave alone so contacts persist.
+        static constexpr float s_Baumgarte = 0.2f;                 // Fraction of the remaining penetration removed per position iteration.
+        static constexpr float s_MaxLinearCorrection = 0.2f;
+        static constexpr float s_SleepLinearVelocity = 0.05f;      // Bodies slower than this in both senses count as still.
+        static constexpr float s_SleepAngularVelocity = 0.035f;
+        static constexpr float s_TimeToSleep = 0.5f;               // An island falls asleep once all its bodies have been still this long.
+        static constexpr float s_ContinuousMotion = 0.5f;          // Continuous bodies moving further than this fraction of their smallest half extent are swept.
+        static constexpr size_t s_MaxTimeOfImpactIterations = 20;
+        static constexpr float s_DistanceTolerance = 1e-4f;        // GJK distance queries stop once the bound on the distance is this tight.
+        static constexpr size_t s_MinColoredRows = 128;            // Smaller islands go to a single thread whole.
+        static constexpr size_t s_MaxColors = 64;                  // The last color takes whatever doesn't fit and is solved on one thread.
+        static constexpr size_t s_PairGrain = 32;
+        static constexpr size_t s_IslandGrain = 4;
+        static constexpr size_t s_ColorGrain = 16;
+        static constexpr size_t s_BodyGrain = 64;
+        static constexpr size_t s_MaxMeshContacts = 16;            // Triangle contacts gathered per body before the manifold picks its four.
+        static constexpr float s_MeshNormalTolerance = 0.7f;       // Triangle contacts whose normal strays further from the deepest one's are left out.
 
         static constexpr size_t s_MaxGJKIterations = 32;
         static constexpr size_t s_MaxEPAIterations = 64;
+        static constexpr size_t s_MaxEPAVertices = 4 + s_MaxEPAIterations;     // The starting tetrahedron plus one point per iteration.
+        static constexpr size_t s_MaxEPAFaces = 2 * s_MaxEPAVertices;           // A closed triangle mesh has 2V - 4 faces.
+        static constexpr size_t s_MaxEPAEdges = 3 * s_MaxEPAFaces;
+        static constexpr size_t s_MaxHeapEPAFaces = 4 * s_MaxEPAFaces;         // Removed faces stay in storage until the heap drops them.
+        static constexpr size_t s_EdgeMapCapacity = 4096;                       // Power of two, keeps every edge a heap EPA can create under half load.
+        static constexpr uint32_t s_NullFace = UINT32_MAX;
+        struct Edge
+        {
+            size_t a;
+            size_t b;
+        };
+        using EdgeBuffer = Buffer<Edge, s_MaxEPAEdges>;
+
+        struct HeapEntry
+        {
+            float distance;
+            uint32_t face;
+        };
 
-        Support GetSupport(const Collider& colliderA, const Transform& transformA, const Collider& colliderB, const Transform& transformB, Vector3 direction);
+        // Open addressed map from a directed edge to the last face created on it, the face across an edge owns its reverse.
+        struct EdgeMap
+        {
+            struct Slot
+            {
+                uint32_t key;
+                uint32_t face;
+            };
+
+            std::array<Slot, s_EdgeMapCapacity> slots;     // Left uninitialised, only slots marked as occupied are read.
+            std::bitset<s_EdgeMapCapacity> occupied;
+
+            void Insert(size_t a, size_t b, uint32_t face);
+            uint32_t Find(size_t a, size_t b) const;
+        };
+        static const CollisionTable s_CollisionTable;
 
-        CollisionInfo GJK(const Collider& colliderA, const Transform& transformA, const Collider& colliderB, const Transform& transformB);
+        PairCache& GetPairCache(uint64_t key, bool& cached);
+        Statistics& GetThreadStatistics();
+        void UpdateNarrowphase();
+        CollisionInfo Collide(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB, Vector3& direction, SupportHints& hints, bool cached);
+        template <CollisionTest Test>
+        CollisionInfo Flipped(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB)
+        {
+            CollisionInfo info = (this->*Test)(colliderB, frameB, colliderA, frameA);
+            info.normal = -info.normal;
+            for (size_t index = 0; index < info.contactCount; ++index) std::swap(info.contacts[index].pointA, info.contacts[index].pointB);
+            return info;
+        }
+
+        CollisionInfo SphereSphere(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB);
+        CollisionInfo SpherePlane(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB);
+        CollisionInfo SphereBox(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB);
+        CollisionInfo BoxPlane(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB);
+        CollisionInfo BoxBox(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB);
+        CollisionInfo CapsuleSphere(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB);
+        CollisionInfo CapsuleCapsule(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB);
+        CollisionInfo CapsulePlane(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB);
+        template <typename T>
+        CollisionInfo ConvexTriangles(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB);
+        CollisionInfo TestSphereSphere(const Vector3& centerA, float radiusA, const Vector3& centerB, float radiusB);
+        CollisionInfo TestSphereBox(const Vector3& center, float radius, const Box& box);
+        CollisionInfo TestBoxBox(const Box& boxA, const Box& boxB);
+        CollisionInfo Combined(const CollisionInfo& first, const CollisionInfo& second);
+        void ClosestPoints(const Capsule& capsuleA, const Capsule& capsuleB, float& s, float& t);
+        Box GetBox(const Frame& frame, const Vector3& halfExtents);
+        Capsule GetCapsule(const Frame& frame, const CapsuleCollider& collider);
+        Bounds GetLocalBounds(const Bounds& bounds, const Frame& frame);
+        inline bool IsUniform(const Vector3& scale);
+
+        Support GetSupport(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB, Vector3 direction, SupportHints& hints);
+
+        CollisionInfo GJK(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB);
+        CollisionInfo GJK(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB, Vector3& direction, SupportHints& hints);
         bool NextSimplex(Simplex& simplex, Vector3& direction);
+        CollisionTest GetCollisionTest(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB);
+        bool IsRoundedBox(const ColliderVariant& collider);
+        void SetRoundedBox(RoundedBoxes& boxes, size_t lane, const ColliderVariant& collider, const Frame& frame);
+        Vector3Lanes GetSupport(const RoundedBoxes& boxes, const Vector3Lanes& direction);
+        Vector3Lanes GetClosestPoint(const Vector3Lanes& point, const Vector3Lanes& a, const Vector3Lanes& b, const Vector3Lanes& c);
+        uint32_t BatchGJK(GJKBatch& batch);
         bool Line(Simplex& simplex, Vector3& direction);
         bool Triangle(Simplex& simplex, Vector3& direction);
         bool Tetrahedron(Simplex& simplex, Vector3& direction);
 
-        CollisionInfo EPA(const Simplex& simplex, const Collider& colliderA, const Transform& transformA, const Collider& colliderB, const Transform& transformB);
-        void AddUniqueEdge(std::vector<std::pair<size_t, size_t>>& edges, size_t a, size_t b);
+        CollisionInfo EPA(const Simplex& simplex, const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB, SupportHints& hints);
+        CollisionInfo HeapEPA(const Simplex& simplex, const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB, SupportHints& hints);
+        CollisionInfo GetEPAContact(const Face& face, const Support* polytope);
+        void AddUniqueEdge(EdgeBuffer& edges, size_t a, size_t b);
+
+        float GetDistance(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB, Vector3& normal, SupportHints& hints);
+        Vector3 ClosestOnSimplex(Buffer<Vector3, 4>& simplex);
+        Vector3 ClosestOnTriangle(const Vector3& a, const Vector3& b, const Vector3& c, Buffer<Vector3, 4>& simplex);
+        float GetTimeOfImpact(const ColliderVariant& colliderA, const Body& bodyA, const ColliderVariant& colliderB, const Body& bodyB);
+        template <typename T>
+        float GetTrianglesTimeOfImpact(const ColliderVariant& collider, const Body& body, const Body& meshBody);
+        void ClampToTimeOfImpact();
 
         inline bool SameDirection(const Vector3& u, const Vector3& v);
         inline Vector3 ConvertToBarycentric(const Vector3& point, const Vector3& a, const Vector3& b, const Vector3& c);
 
-        void ResolveCollision(Physics& physicsA, Transform& transformA, Physics& physicsB, Transform& transformB, const CollisionInfo& collision);
+        size_t ReduceContacts(const Vector3* points, const float* depths, size_t count, const Vector3& normal, std::array<size_t, s_MaxContacts>& selected);
+        void UpdateManifold(Manifold& manifold, const CollisionInfo& collision, const Frame& frameA, const Frame& frameB);
+        void SetDynamics(uint32_t index);
+        void WakeBody(uint32_t index);
+        uint32_t FindIsland(uint32_t body);
+        void MergeIslands(uint32_t bodyA, uint32_t bodyB);
+        void UpdateSleep(float deltaTime);
+        void BuildIslands();
+        void ColorIsland(Island& island);
+        void PrepareContacts();
+        void WarmStart(size_t beginRow, size_t endRow);
+        void SolveVelocityConstraints(size_t beginRow, size_t endRow);
+        float SolvePositionConstraints(size_t beginRow, size_t endRow);
+        void StoreImpulses();
+        void IntegrateVelocities(float deltaTime);
+        void IntegratePositions(float deltaTime);
+        void SolveIslands(float deltaTime);
+
+        template <typename F>
+        void ParallelFor(size_t count, size_t grain, F&& function)
+        {
+            if (mp_ThreadPool) mp_ThreadPool->ParallelFor(count, grain, function);
+            else if (count > 0) function(0, count);
+        }
+
+        // Calls function(beginRow, endRow) over the colors of an island in order, each color spread over the threads.
+        template <typename F>
+        void ForEachColor(const Island& island, F&& function)
+        {
+            for (size_t color = 0; color < island.colorCount; ++color)
+            {
+                size_t begin = m_ColorOffsets[island.firstColor + color];
+                size_t end = m_ColorOffsets[island.firstColor + color + 1];
+                size_t grain = color == s_MaxColors - 1 ? end - begin : s_ColorGrain;   // The overflow color may share bodies.
+                ParallelFor(end - begin, grain, [&](size_t first, size_t last) { function(m_ManifoldRows[begin + first], m_ManifoldRows[begin + last]); });
+            }
+        }
+        inline void ApplyImpulse(uint32_t bodyA, uint32_t bodyB, const Vector3& relativeA, const Vector3& relativeB, const Vector3& impulse);
 
         public:
 
@@ -99,6 +508,31 @@ namespace Engine
         ~Solver() = default;
         float GetGravity() const;
         void SetGravity(float gravity);
+        template <BroadphaseConcept T>
+        void SetBroadphase(T&& broadphase) { mp_Broadphase = std::make_unique<std::decay_t<T>>(std::forward<T>(broadphase)); }
+        const Broadphase::Statistics& GetBroadphaseStatistics() const;
+        const Statistics& GetStatistics() const;
+        EPAMode GetEPAMode() const;
+        void SetEPAMode(EPAMode mode);
+        size_t GetVelocityIterations() const;
+        void SetVelocityIterations(size_t iterations);
+        size_t GetPositionIterations() const;
+        void SetPositionIterations(size_t iterations);
+        bool IsSleepEnabled() const;
+        void SetSleepEnabled(bool enabled);
+        bool IsBatchedGJKEnabled() const;
+        void SetBatchedGJKEnabled(bool enabled);
+        bool IsBatchedIntegrationEnabled() const;
+        void SetBatchedIntegrationEnabled(bool enabled);
+        size_t GetThreadCount() const;
+        void SetThreadCount(size_t threadCount);
+        float GetFixedTimeStep() const;
+        void SetFixedTimeStep(float fixedTimeStep);
+        size_t GetMaxSteps() const;
+        void SetMaxSteps(size_t maxSteps);
+        size_t GetSubsteps() const;
+        void SetSubsteps(size_t substeps);
+        float Simulate(World& world, float frameTime);
         void Solve(World& world, float deltaTime);
 
     };
@@ -4,6 +4,21 @@
 
 namespace Engine
 {
+    // Affine 3x4 snapshot of a transform and its inverse, built once per step so collision queries don't rebuild 4x4 matrices.
+    struct Frame
+    {
+        Matrix3 rotation;
+        Matrix3 linear;         // Rotation * scale.
+        Matrix3 inverseLinear;  // Inverse scale * inverse rotation.
+        Vector3 scale;
+        Vector3 position;
+
+        inline Vector3 ToWorldPoint(const Vector3& point) const { return linear * point + position; }
+        inline Vector3 ToLocalPoint(const Vector3& point) const { return inverseLinear * (point - position); }
+        inline Vector3 ToLocalDirection(const Vector3& direction) const { return inverseLinear * direction; }
+        inline Vector3 ToLocalNormal(const Vector3& normal) const { return normal * linear; }     // Search directions are normals, a non uniform scale maps them through the transposed linear part.
+    };
+
     class Transform : public Component
     {
         public:
@@ -11,6 +26,9 @@ namespace Engine
         Vector3 m_Scale = Vector3(1.0f);
         Vector3 m_Position = Vector3(0.0f);
         Quaternion m_Orientation = Quaternion(0.0f, 0.0f, 0.0f);
+        Vector3 m_PreviousPosition = Vector3(0.0f);                     // Pose before the last physics step, for interpolated rendering.
+        Quaternion m_PreviousOrientation = Quaternion(0.0f, 0.0f, 0.0f);
+        bool m_HasPreviousPose = false;
 
         public:
 
@@ -18,6 +36,10 @@ namespace Engine
         Vector3 GetPosition() const;
         Quaternion GetOrientation() const;
         Quaternion GetInverseOrientation() const;
+        bool HasPreviousPose() const;
+        Vector3 GetPreviousPosition() const;
+        Quaternion GetPreviousOrientation() const;
+        void StorePreviousPose();
         Matrix4 GetScalingMatrix() const;
         Matrix4 GetInverseScalingMatrix() const;
         Matrix4 GetRotationMatrix() const;
@@ -26,8 +48,10 @@ namespace Engine
         Matrix4 GetInverseTranslationMatrix() const;
         Matrix4 GetWorldMatrix() const;
         Matrix4 GetInverseWorldMatrix() const;
+        Frame GetFrame() const;
         void RotateAround(const Vector3& vector, float degrees);
         void RotateTo(float angleAroundX, float angleAroundY, float angleAroundZ);
+        void RotateTo(const Quaternion& orientation);
         void RotateBy(float deltaAngleAroundX, float deltaAngleAroundY, float deltaAngleAroundZ);
         void ScaleTo(float scaleX, float scaleY, float scaleZ);
         void ScaleBy(float scalarX, float scalarY, float scalarZ);
@@ -37,4 +61,7 @@ namespace Engine
         void TranslateBy(const Vector3& delta);
 
     };
+
+    // Pose a fraction alpha of the way from the previous physics step to the current one, transforms never stepped are returned as they are.
+    Transform Interpolated(const Transform& transform, float alpha);
 }
@@ -0,0 +1,524 @@
+#include <chrono>
+#include <engine/core/broadphase.hpp>
+
+namespace Engine
+{
+    static float GetElapsedTime(std::chrono::steady_clock::time_point& start)
+    {
+        auto now = std::chrono::steady_clock::now();
+        float elapsed = std::chrono::duration<float>(now - start).count();
+        start = now;
+        return elapsed;
+    }
+
+    void BruteForce::Update(const std::vector<Proxy>& proxies, std::vector<Pair>& pairs)
+    {
+        auto start = std::chrono::steady_clock::now();
+        pairs.clear();
+        for (uint32_t a = 0; a < proxies.size(); ++a)
+        {
+            for (uint32_t b = a + 1; b < proxies.size(); ++b)
+            {
+                if (proxies[a].bounds.Overlaps(proxies[b].bounds)) pairs.push_back({ a, b });
+            }
+        }
+        m_Statistics.queryTime = GetElapsedTime(start);
+        m_Statistics.pairCount = pairs.size();
+    }
+
+    void SweepAndPrune::Update(const std::vector<Proxy>& proxies, std::vector<Pair>& pairs)
+    {
+        auto start = std::chrono::steady_clock::now();
+        pairs.clear();
+        ++m_Stamp;
+
+        size_t insertedCount = 0;
+        Vector3 sum = Vector3(0.0f);
+        Vector3 sumSquared = Vector3(0.0f);
+        for (uint32_t index = 0; index < proxies.size(); ++index)
+        {
+            const Proxy& proxy = proxies[index];
+            if (proxy.id >= m_Slots.size()) m_Slots.resize(proxy.id + 1);
+
+            Slot& slot = m_Slots[proxy.id];
+            if (!slot.inserted)
+            {
+                ++insertedCount;
+                // New proxies are appended, the insertion sort below moves them into place.
+                for (auto& axis : m_Axes)
+                {
+                    axis.push_back({ 0.0f, proxy.id, false });
+                    axis.push_back({ 0.0f, proxy.id, true });
+                }
+                slot.inserted = true;
+                ++m_InsertedCount;
+            }
+            slot.bounds = proxy.bounds;
+            slot.proxy = index;
+            slot.stamp = m_Stamp;
+
+            Vector3 center = proxy.bounds.GetCenter();
+            sum += center;
+            sumSquared += Hadamard(center, center);
+        }
+
+        // Drop proxies that were not seen this step (removed bodies).
+        if (m_InsertedCount > proxies.size())
+        {
+            for (auto& axis : m_Axes) std::erase_if(axis, [this](const Endpoint& endpoint) { return m_Slots[endpoint.slot].stamp != m_Stamp; });
+            for (Slot& slot : m_Slots)
+            {
+                if (slot.inserted && slot.stamp != m_Stamp)
+                {
+                    slot.inserted = false;
+                    --m_InsertedCount;
+                }
+            }
+        }
+        m_Statistics.buildTime = GetElapsedTime(start);
+
+        // Refresh endpoint values and restore ordering, bodies move little between steps so this is close to linear.
+        // Appended endpoints can be far from their place though, large batches of them get a full sort instead.
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            std::vector<Endpoint>& endpoints = m_Axes[axis];
+            for (Endpoint& endpoint : endpoints)
+            {
+                const Bounds& bounds = m_Slots[endpoint.slot].bounds;
+                endpoint.value = endpoint.maximum ? bounds.max[axis] : bounds.min[axis];
+            }
+            if (insertedCount > s_InsertionSortLimit)
+            {
+                std::sort(endpoints.begin(), endpoints.end());
+                continue;
+            }
+            for (size_t index = 1; index < endpoints.size(); ++index)
+            {
+                Endpoint endpoint = endpoints[index];
+                size_t position = index;
+                while (position > 0 && endpoint < endpoints[position - 1])
+                {
+                    endpoints[position] = endpoints[position - 1];
+                    --position;
+                }
+                endpoints[position] = endpoint;
+            }
+        }
+
+        m_Statistics.refitTime = GetElapsedTime(start);
+
+        // Sweep along the axis where the bodies are the most spread out.
+        size_t sweepAxis = 0;
+        if (!proxies.empty())
+        {
+            Vector3 mean = sum / static_cast<float>(proxies.size());
+            Vector3 variance = sumSquared / static_cast<float>(proxies.size()) - Hadamard(mean, mean);
+            if (variance.y > variance[sweepAxis]) sweepAxis = 1;
+            if (variance.z > variance[sweepAxis]) sweepAxis = 2;
+        }
+
+        m_Active.clear();
+        for (const Endpoint& endpoint : m_Axes[sweepAxis])
+        {
+            if (endpoint.maximum)
+            {
+                for (size_t index = 0; index < m_Active.size(); ++index)
+                {
+                    if (m_Active[index] != endpoint.slot) continue;
+                    m_Active[index] = m_Active.back();
+                    m_Active.pop_back();
+                    break;
+                }
+                continue;
+            }
+
+            const Slot& slot = m_Slots[endpoint.slot];
+            for (uint32_t other : m_Active)
+            {
+                const Slot& otherSlot = m_Slots[other];
+                if (!slot.bounds.Overlaps(otherSlot.bounds)) continue;
+                pairs.push_back({ std::min(slot.proxy, otherSlot.proxy), std::max(slot.proxy, otherSlot.proxy) });
+            }
+            m_Active.push_back(endpoint.slot);
+        }
+        m_Statistics.queryTime = GetElapsedTime(start);
+        m_Statistics.pairCount = pairs.size();
+    }
+
+    DynamicTree::DynamicTree(float margin) : m_Margin(margin) {}
+    float DynamicTree::GetMargin() const { return m_Margin; }
+    void DynamicTree::SetMargin(float margin) { m_Margin = margin; }
+    size_t DynamicTree::GetHeight() const { return (m_Root == s_Null) ? 0 : m_Nodes[m_Root].height; }
+
+    uint32_t DynamicTree::AllocateNode()
+    {
+        if (m_FreeList == s_Null)
+        {
+            m_Nodes.emplace_back();
+            return static_cast<uint32_t>(m_Nodes.size() - 1);
+        }
+        uint32_t node = m_FreeList;
+        m_FreeList = m_Nodes[node].parent;
+        m_Nodes[node] = Node();
+        return node;
+    }
+    void DynamicTree::FreeNode(uint32_t node)
+    {
+        m_Nodes[node].parent = m_FreeList;
+        m_Nodes[node].height = -1;
+        m_FreeList = node;
+    }
+    void DynamicTree::InsertLeaf(uint32_t leaf)
+    {
+        if (m_Root == s_Null)
+        {
+            m_Root = leaf;
+            m_Nodes[leaf].parent = s_Null;
+            return;
+        }
+
+        // Descend towards the sibling that minimizes the surface area added to the tree.
+        Bounds bounds = m_Nodes[leaf].bounds;
+        uint32_t index = m_Root;
+        while (!m_Nodes[index].IsLeaf())
+        {
+            const Node& node = m_Nodes[index];
+            float area = node.bounds.GetSurfaceArea();
+            float combinedArea = Merged(node.bounds, bounds).GetSurfaceArea();
+            float cost = 2.0f * combinedArea;
+            float inheritanceCost = 2.0f * (combinedArea - area);
+
+            float childCosts[2];
+            for (size_t child = 0; child < 2; ++child)
+            {
+                const Node& childNode = m_Nodes[node.children[child]];
+                float childArea = Merged(childNode.bounds, bounds).GetSurfaceArea();
+                if (!childNode.IsLeaf()) childArea -= childNode.bounds.GetSurfaceArea();
+                childCosts[child] = childArea + inheritanceCost;
+            }
+
+            if (cost < childCosts[0] && cost < childCosts[1]) break;
+            index = (childCosts[0] < childCosts[1]) ? node.children[0] : node.children[1];
+        }
+
+        uint32_t sibling = index;
+        uint32_t oldParent = m_Nodes[sibling].parent;
+        uint32_t newParent = AllocateNode();
+        m_Nodes[newParent].parent = oldParent;
+        m_Nodes[newParent].bounds = Merged(bounds, m_Nodes[sibling].bounds);
+        m_Nodes[newParent].height = m_Nodes[sibling].height + 1;
+        m_Nodes[newParent].children[0] = sibling;
+        m_Nodes[newParent].children[1] = leaf;
+        m_Nodes[sibling].parent = newParent;
+        m_Nodes[leaf].parent = newParent;
+
+        if (oldParent == s_Null) m_Root = newParent;
+        else if (m_Nodes[oldParent].children[0] == sibling) m_Nodes[oldParent].children[0] = newParent;
+        else m_Nodes[oldParent].children[1] = newParent;
+
+        Refit(newParent);
+    }
+    void DynamicTree::RemoveLeaf(uint32_t leaf)
+    {
+        if (leaf == m_Root)
+        {
+            m_Root = s_Null;
+            return;
+        }
+
+        uint32_t parent = m_Nodes[leaf].parent;
+        uint32_t grandParent = m_Nodes[parent].parent;
+        uint32_t sibling = (m_Nodes[parent].children[0] == leaf) ? m_Nodes[parent].children[1] : m_Nodes[parent].children[0];
+
+        FreeNode(parent);
+        m_Nodes[sibling].parent = grandParent;
+        if (grandParent == s_Null)
+        {
+            m_Root = sibling;
+            return;
+        }
+
+        if (m_Nodes[grandParent].children[0] == parent) m_Nodes[grandParent].children[0] = sibling;
+        else m_Nodes[grandParent].children[1] = sibling;
+        Refit(grandParent);
+    }
+    void DynamicTree::Refit(uint32_t node)
+    {
+        // Walk back to the root, rebalancing and fixing bounds and heights on the way.
+        while (node != s_Null)
+        {
+            node = Balance(node);
+            Node& current = m_Nodes[node];
+            const Node& left = m_Nodes[current.children[0]];
+            const Node& right = m_Nodes[current.children[1]];
+            current.height = 1 + std::max(left.height, right.height);
+            current.bounds = Merged(left.bounds, right.bounds);
+            node = current.parent;
+        }
+    }
+    uint32_t DynamicTree::Balance(uint32_t a)
+    {
+        Node& A = m_Nodes[a];
+        if (A.IsLeaf() || A.height < 2) return a;
+
+        uint32_t b = A.children[0];
+        uint32_t c = A.children[1];
+        Node& B = m_Nodes[b];
+        Node& C = m_Nodes[c];
+        int32_t balance = C.height - B.height;
+
+        // Rotate the taller child up, it takes the place of its parent which adopts one of its children.
+        auto rotate = [&](uint32_t up, Node& Up, uint32_t upSlot, Node& Other)
+        {
+            uint32_t f = Up.children[0];
+            uint32_t g = Up.children[1];
+            Node& F = m_Nodes[f];
+            Node& G = m_Nodes[g];
+
+            Up.children[0] = a;
+            Up.parent = A.parent;
+            A.parent = up;
+
+            if (Up.parent == s_Null) m_Root = up;
+            else if (m_Nodes[Up.parent].children[0] == a) m_Nodes[Up.parent].children[0] = up;
+            else m_Nodes[Up.parent].children[1] = up;
+
+            // Keep the taller grandchild under the rotated node, hand the shorter one down to the old parent.
+            uint32_t kept = (F.height > G.height) ? f : g;
+            uint32_t given = (F.height > G.height) ? g : f;
+            Up.children[1] = kept;
+            A.children[upSlot] = given;
+            m_Nodes[given].parent = a;
+
+            A.bounds = Merged(Other.bounds, m_Nodes[given].bounds);
+            A.height = 1 + std::max(Other.height, m_Nodes[given].height);
+            Up.bounds = Merged(A.bounds, m_Nodes[kept].bounds);
+            Up.height = 1 + std::max(A.height, m_Nodes[kept].height);
+            return up;
+        };
+
+        if (balance > 1) return rotate(c, C, 1, B);
+        if (balance < -1) return rotate(b, B, 0, C);
+        return a;
+    }
+
+    void DynamicTree::Update(const std::vector<Proxy>& proxies, std::vector<Pair>& pairs)
+    {
+        auto start = std::chrono::steady_clock::now();
+        pairs.clear();
+        m_Moved.clear();
+        ++m_Stamp;
+
+        for (uint32_t index = 0; index < proxies.size(); ++index)
+        {
+            const Proxy& proxy = proxies[index];
+            if (proxy.id >= m_Slots.size()) m_Slots.resize(proxy.id + 1);
+
+            Slot& slot = m_Slots[proxy.id];
+            slot.bounds = proxy.bounds;
+            slot.proxy = index;
+            slot.stamp = m_Stamp;
+            if (slot.leaf == s_Null)
+            {
+                slot.leaf = AllocateNode();
+                m_Nodes[slot.leaf].bounds = Inflated(proxy.bounds, m_Margin);
+                m_Nodes[slot.leaf].slot = proxy.id;
+                InsertLeaf(slot.leaf);
+                ++m_LeafCount;
+            }
+            else if (!m_Nodes[slot.leaf].bounds.Contains(proxy.bounds)) m_Moved.push_back(proxy.id);
+        }
+
+        // Drop proxies that were not seen this step (removed bodies).
+        if (m_LeafCount > proxies.size())
+        {
+            for (Slot& slot : m_Slots)
+            {
+                if (slot.leaf == s_Null || slot.stamp == m_Stamp) continue;
+                RemoveLeaf(slot.leaf);
+                FreeNode(slot.leaf);
+                slot.leaf = s_Null;
+                --m_LeafCount;
+            }
+        }
+        m_Statistics.buildTime = GetElapsedTime(start);
+
+        // Only bodies that left their fat bounds are reinserted.
+        for (uint32_t id : m_Moved)
+        {
+            Slot& slot = m_Slots[id];
+            RemoveLeaf(slot.leaf);
+            m_Nodes[slot.leaf].bounds = Inflated(slot.bounds, m_Margin);
+            InsertLeaf(slot.leaf);
+        }
+        m_Statistics.refitTime = GetElapsedTime(start);
+
+        // Self-collide the tree, every subtree pair is visited once so each overlapping pair is only found once.
+        m_Stack.clear();
+        if (m_Root != s_Null) m_Stack.push_back({ m_Root, m_Root });
+        while (!m_Stack.empty())
+        {
+            auto [a, b] = m_Stack.back();
+            m_Stack.pop_back();
+            const Node& A = m_Nodes[a];
+            const Node& B = m_Nodes[b];
+
+            if (a == b)
+            {
+                if (A.IsLeaf()) continue;
+                m_Stack.push_back({ A.children[0], A.children[0] });
+                m_Stack.push_back({ A.children[1], A.children[1] });
+                m_Stack.push_back({ A.children[0], A.children[1] });
+                continue;
+            }
+
+            if (!A.bounds.Overlaps(B.bounds)) continue;
+            if (A.IsLeaf() && B.IsLeaf())
+            {
+                const Slot& slotA = m_Slots[A.slot];
+                const Slot& slotB = m_Slots[B.slot];
+                if (slotA.bounds.Overlaps(slotB.bounds)) pairs.push_back({ std::min(slotA.proxy, slotB.proxy), std::max(slotA.proxy, slotB.proxy) });
+            }
+            else if (B.IsLeaf() || (!A.IsLeaf() && A.height >= B.height))
+            {
+                m_Stack.push_back({ A.children[0], b });
+                m_Stack.push_back({ A.children[1], b });
+            }
+            else
+            {
+                m_Stack.push_back({ a, B.children[0] });
+                m_Stack.push_back({ a, B.children[1] });
+            }
+        }
+        m_Statistics.queryTime = GetElapsedTime(start);
+        m_Statistics.pairCount = pairs.size();
+    }
+
+    SpatialHash::SpatialHash(float cellSize) : m_CellSize(cellSize), m_InverseCellSize(1.0f / cellSize) {}
+    float SpatialHash::GetCellSize() const { return m_CellSize; }
+    void SpatialHash::SetCellSize(float cellSize)
+    {
+        m_CellSize = cellSize;
+        m_InverseCellSize = 1.0f / cellSize;
+    }
+    uint32_t SpatialHash::FindOrInsertCell(int32_t x, int32_t y, int32_t z)
+    {
+        uint32_t mask = static_cast<uint32_t>(m_Cells.size() - 1);
+        uint32_t index = (static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u ^ static_cast<uint32_t>(z) * 83492791u) & mask;
+        while (true)
+        {
+            Cell& cell = m_Cells[index];
+            if (cell.stamp != m_Stamp)
+            {
+                cell = { x, y, z, m_Stamp, 0, 0 };
+                m_Occupied.push_back(index);
+                return index;
+            }
+            if (cell.x == x && cell.y == y && cell.z == z) return index;
+            index = (index + 1) & mask;
+        }
+    }
+
+    void SpatialHash::Update(const std::vector<Proxy>& proxies, std::vector<Pair>& pairs)
+    {
+        auto start = std::chrono::steady_clock::now();
+        pairs.clear();
+        m_Occupied.clear();
+        m_Insertions.clear();
+        m_Oversized.clear();
+        m_IsOversized.assign(proxies.size(), false);
+        ++m_Stamp;
+
+        size_t entryCount = 0;
+        for (uint32_t index = 0; index < proxies.size(); ++index)
+        {
+            Vector3 span = (proxies[index].bounds.max - proxies[index].bounds.min) * m_InverseCellSize + Vector3(1.0f);
+            if (span.x * span.y * span.z > s_MaxCellsPerProxy)
+            {
+                m_Oversized.push_back(index);
+                m_IsOversized[index] = true;
+            }
+            else entryCount += static_cast<size_t>(span.x + 1.0f) * static_cast<size_t>(span.y + 1.0f) * static_cast<size_t>(span.z + 1.0f);
+        }
+
+        // Keep the table at most half full, it only ever grows so steady state steps do not allocate.
+        size_t capacity = 16;
+        while (capacity < 2 * entryCount) capacity *= 2;
+        if (capacity > m_Cells.size())
+        {
+            m_Cells.assign(capacity, Cell());
+            m_Stamp = 1;
+        }
+
+        for (uint32_t index = 0; index < proxies.size(); ++index)
+        {
+            if (m_IsOversized[index]) continue;
+            const Bounds& bounds = proxies[index].bounds;
+            int32_t minX = GetCellCoordinate(bounds.min.x), maxX = GetCellCoordinate(bounds.max.x);
+            int32_t minY = GetCellCoordinate(bounds.min.y), maxY = GetCellCoordinate(bounds.max.y);
+            int32_t minZ = GetCellCoordinate(bounds.min.z), maxZ = GetCellCoordinate(bounds.max.z);
+            for (int32_t x = minX; x <= maxX; ++x)
+            {
+                for (int32_t y = minY; y <= maxY; ++y)
+                {
+                    for (int32_t z = minZ; z <= maxZ; ++z)
+                    {
+                        uint32_t cell = FindOrInsertCell(x, y, z);
+                        ++m_Cells[cell].count;
+                        m_Insertions.push_back({ cell, index });
+                    }
+                }
+            }
+        }
+
+        // Lay every cell's proxies out contiguously.
+        uint32_t offset = 0;
+        for (uint32_t index : m_Occupied)
+        {
+            Cell& cell = m_Cells[index];
+            cell.begin = offset;
+            offset += cell.count;
+            cell.count = 0;
+        }
+        m_Entries.resize(offset);
+        for (auto [index, proxy] : m_Insertions)
+        {
+            Cell& cell = m_Cells[index];
+            m_Entries[cell.begin + cell.count++] = proxy;
+        }
+        m_Statistics.buildTime = GetElapsedTime(start);
+        m_Statistics.refitTime = 0.0f;
+
+        for (uint32_t index : m_Occupied)
+        {
+            const Cell& cell = m_Cells[index];
+            for (uint32_t i = cell.begin; i < cell.begin + cell.count; ++i)
+            {
+                for (uint32_t j = i + 1; j < cell.begin + cell.count; ++j)
+                {
+                    const Bounds& a = proxies[m_Entries[i]].bounds;
+                    const Bounds& b = proxies[m_Entries[j]].bounds;
+                    if (!a.Overlaps(b)) continue;
+
+                    // Proxies sharing several cells only report from the cell holding the minimum corner of their overlap.
+                    if (GetCellCoordinate(Max(a.min.x, b.min.x)) != cell.x ||
+                        GetCellCoordinate(Max(a.min.y, b.min.y)) != cell.y ||
+                        GetCellCoordinate(Max(a.min.z, b.min.z)) != cell.z) continue;
+
+                    pairs.push_back({ std::min(m_Entries[i], m_Entries[j]), std::max(m_Entries[i], m_Entries[j]) });
+                }
+            }
+        }
+
+        for (uint32_t oversized : m_Oversized)
+        {
+            for (uint32_t index = 0; index < proxies.size(); ++index)
+            {
+                if (index == oversized || (m_IsOversized[index] && index < oversized)) continue;
+                if (proxies[oversized].bounds.Overlaps(proxies[index].bounds)) pairs.push_back({ std::min(index, oversized), std::max(index, oversized) });
+            }
+        }
+        m_Statistics.queryTime = GetElapsedTime(start);
+        m_Statistics.pairCount = pairs.size();
+    }
+}
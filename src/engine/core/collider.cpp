@@ -1,23 +1,17 @@
+#include <array>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
 #include <engine/core/collider.hpp>
+#include <engine/core/utilities.hpp>
 
 namespace Engine
 {
-    Vector3 Collider::GetWorldSupport(const Transform& transform, const Vector3& direction) const
-    {
-        Vector3 localDirection = transform.GetInverseWorldMatrix() * Vector4(direction, 0.0f);
-        return transform.GetWorldMatrix() * Vector4(GetSupport(localDirection), 1.0f);
-    }
-    Matrix3 Collider::GetInverseInertiaTensor(float mass) const { return Inversed(GetInertiaTensor(mass)); }
+    Collider::Shape Collider::GetShape() const { return m_Shape; }
 
-    CubeCollider::CubeCollider(float length) : m_HalfLength(length * 0.5) { m_Shape = Shape::Cube; }
-    Vector3 CubeCollider::GetSupport(const Vector3& direction) const
-    {
-        return Vector3(
-            (direction.x >= 0) ? m_HalfLength : -m_HalfLength,
-            (direction.y >= 0) ? m_HalfLength : -m_HalfLength,
-            (direction.z >= 0) ? m_HalfLength : -m_HalfLength
-        );
-    }
+    CubeCollider::CubeCollider(float length) : Collider(Shape::Cube), m_HalfLength(length * 0.5) {}
+    float CubeCollider::GetHalfLength() const { return m_HalfLength; }
     Matrix3 CubeCollider::GetInertiaTensor(float mass) const
     {
         float i = mass * m_HalfLength * m_HalfLength * 2.0f / 3.0f;
@@ -28,15 +22,8 @@ namespace Engine
         );
     }
 
-    PlaneCollider::PlaneCollider(float length) : m_HalfLength(length * 0.5) { m_Shape = Shape::Plane; }
-    Vector3 PlaneCollider::GetSupport(const Vector3& direction) const
-    {
-        return Vector3(
-            (direction.x >= 0) ? m_HalfLength : -m_HalfLength,
-            (direction.y >= 0) ? m_HalfLength : -m_HalfLength,
-            0.0f
-        );
-    }
+    PlaneCollider::PlaneCollider(float length) : Collider(Shape::Plane), m_HalfLength(length * 0.5) {}
+    float PlaneCollider::GetHalfLength() const { return m_HalfLength; }
     Matrix3 PlaneCollider::GetInertiaTensor(float mass) const
     {
         float ixy = (mass * m_HalfLength * m_HalfLength) / 3.0f;
@@ -47,8 +34,8 @@ namespace Engine
         );
     }
 
-    SphereCollider::SphereCollider(float radius) : m_Radius(radius) { m_Shape = Shape::Sphere; }
-    Vector3 SphereCollider::GetSupport(const Vector3& direction) const { return Normalized(direction) * m_Radius; }
+    SphereCollider::SphereCollider(float radius) : Collider(Shape::Sphere), m_Radius(radius) {}
+    float SphereCollider::GetRadius() const { return m_Radius; }
     Matrix3 SphereCollider::GetInertiaTensor(float mass) const
     {
         float i = (2.0f / 5.0f) * mass * m_Radius * m_Radius;
@@ -58,4 +45,445 @@ namespace Engine
             0, 0, i
         );
     }
+
+    CapsuleCollider::CapsuleCollider(float radius, float length) : Collider(Shape::Capsule), m_Radius(radius), m_HalfLength(length * 0.5) {}
+    float CapsuleCollider::GetRadius() const { return m_Radius; }
+    float CapsuleCollider::GetHalfLength() const { return m_HalfLength; }
+    Matrix3 CapsuleCollider::GetInertiaTensor(float mass) const
+    {
+        // Cylinder plus the two caps as one sphere pushed out along the axis, mass split by volume.
+        float length = 2.0f * m_HalfLength;
+        float radiusSquared = m_Radius * m_Radius;
+        float cylinderVolume = length;
+        float capsVolume = (4.0f / 3.0f) * m_Radius;
+        float cylinderMass = mass * cylinderVolume / (cylinderVolume + capsVolume);
+        float capsMass = mass - cylinderMass;
+        float ixy = cylinderMass * (radiusSquared / 4.0f + length * length / 12.0f) + capsMass * (2.0f * radiusSquared / 5.0f + length * length / 4.0f + 3.0f * length * m_Radius / 8.0f);
+        float iz = cylinderMass * radiusSquared / 2.0f + capsMass * 2.0f * radiusSquared / 5.0f;
+        return Matrix3(
+             ixy,    0.0f, 0.0f,
+            0.0f,     ixy, 0.0f,
+            0.0f,    0.0f,   iz
+        );
+    }
+
+    std::unordered_map<std::string, std::weak_ptr<const ConvexHullCollider::Hull>> ConvexHullCollider::s_Cache;
+    ConvexHullCollider::Hull::Hull(std::vector<Vector3> points)
+    {
+        // Vertices split by the OBJ loader for their normals and texture coordinates share a position.
+        auto less = [](const Vector3& a, const Vector3& b) { return a.x != b.x ? a.x < b.x : a.y != b.y ? a.y < b.y : a.z < b.z; };
+        std::sort(points.begin(), points.end(), less);
+        points.erase(std::unique(points.begin(), points.end(), [](const Vector3& a, const Vector3& b) { return a.x == b.x && a.y == b.y && a.z == b.z; }), points.end());
+        if (points.size() < 4) throw std::runtime_error("Could not build convex hull from fewer than four points.");
+
+        // Quickhull. Points closer to a face than the tolerance count as on it, so nearly flat regions don't grow slivers.
+        float extent = 0.0f;
+        for (const Vector3& point : points) extent = Max(extent, Max(Abs(point.x), Max(Abs(point.y), Abs(point.z))));
+        float tolerance = 1e-5f * extent;
+
+        struct Face
+        {
+            uint32_t vertices[3];
+            Vector3 normal;
+            float offset;
+            std::vector<uint32_t> outside;      // Points above the face that no earlier face claimed.
+            bool removed;
+            bool visible;
+        };
+        std::vector<Face> faces;
+        std::unordered_map<uint64_t, uint32_t> edges;   // Directed edge to the face it belongs to, the twin edge leads to the neighbour.
+        auto edge = [](uint32_t from, uint32_t to) { return static_cast<uint64_t>(from) << 32 | to; };
+        auto distance = [&](const Face& face, uint32_t point) { return Dot(face.normal, points[point]) - face.offset; };
+        auto addFace = [&](uint32_t a, uint32_t b, uint32_t c)
+        {
+            Vector3 normal = Normalized(Cross(points[b] - points[a], points[c] - points[a]));
+            faces.push_back({ { a, b, c }, normal, Dot(normal, points[a]), {}, false, false });
+            uint32_t face = static_cast<uint32_t>(faces.size() - 1);
+            edges[edge(a, b)] = face;
+            edges[edge(b, c)] = face;
+            edges[edge(c, a)] = face;
+        };
+        auto assign = [&](uint32_t point, size_t firstFace)
+        {
+            for (size_t face = firstFace; face < faces.size(); ++face)
+            {
+                if (faces[face].removed || distance(faces[face], point) <= tolerance) continue;
+                faces[face].outside.push_back(point);
+                return;
+            }
+        };
+
+        // Start from the two extreme points furthest apart, the point furthest from their line and the one furthest from their plane.
+        uint32_t a = 0;
+        uint32_t b = 0;
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            auto [low, high] = std::minmax_element(points.begin(), points.end(), [axis](const Vector3& p, const Vector3& q) { return p[axis] < q[axis]; });
+            if (LengthSquared(*high - *low) <= LengthSquared(points[b] - points[a])) continue;
+            a = static_cast<uint32_t>(low - points.begin());
+            b = static_cast<uint32_t>(high - points.begin());
+        }
+        auto furthest = [&](auto measure)
+        {
+            uint32_t best = 0;
+            for (uint32_t point = 1; point < points.size(); ++point) if (measure(point) > measure(best)) best = point;
+            return best;
+        };
+        Vector3 line = points[b] - points[a];
+        uint32_t c = furthest([&](uint32_t point) { return LengthSquared(Cross(points[point] - points[a], line)); });
+        Vector3 normal = Cross(line, points[c] - points[a]);
+        uint32_t d = furthest([&](uint32_t point) { return Abs(Dot(points[point] - points[a], normal)); });
+        if (Abs(Dot(points[d] - points[a], Normalized(normal))) <= tolerance) throw std::runtime_error("Could not build convex hull from flat mesh.");
+        if (Dot(points[d] - points[a], normal) > 0.0f) std::swap(b, c);
+        addFace(a, b, c);
+        addFace(b, a, d);
+        addFace(c, b, d);
+        addFace(a, c, d);
+        for (uint32_t point = 0; point < points.size(); ++point)
+        {
+            if (point != a && point != b && point != c && point != d) assign(point, 0);
+        }
+
+        // New faces go to the back, so one pass handles them too.
+        std::vector<uint32_t> visible;
+        std::vector<std::pair<uint32_t, uint32_t>> horizon;
+        std::vector<uint32_t> orphans;
+        for (size_t index = 0; index < faces.size(); ++index)
+        {
+            if (faces[index].removed || faces[index].outside.empty()) continue;
+            const std::vector<uint32_t>& outside = faces[index].outside;
+            uint32_t eye = *std::max_element(outside.begin(), outside.end(), [&](uint32_t p, uint32_t q) { return distance(faces[index], p) < distance(faces[index], q); });
+
+            // Every face the eye sees is connected to this one, the edges towards faces it doesn't see form the horizon.
+            // Visibility is exact, a face the eye sits just above must go too or it can end up walled in by new faces.
+            visible.assign(1, static_cast<uint32_t>(index));
+            horizon.clear();
+            faces[index].visible = true;
+            for (size_t next = 0; next < visible.size(); ++next)
+            {
+                const Face& face = faces[visible[next]];
+                for (size_t corner = 0; corner < 3; ++corner)
+                {
+                    uint32_t from = face.vertices[corner];
+                    uint32_t to = face.vertices[(corner + 1) % 3];
+                    Face& neighbour = faces[edges.at(edge(to, from))];
+                    if (neighbour.visible) continue;
+                    if (distance(neighbour, eye) > 0.0f)
+                    {
+                        neighbour.visible = true;
+                        visible.push_back(edges.at(edge(to, from)));
+                    }
+                    else horizon.emplace_back(from, to);
+                }
+            }
+
+            orphans.clear();
+            size_t firstFace = faces.size();
+            for (uint32_t face : visible)
+            {
+                Face& removed = faces[face];
+                for (uint32_t point : removed.outside) if (point != eye) orphans.push_back(point);
+                for (size_t corner = 0; corner < 3; ++corner) edges.erase(edge(removed.vertices[corner], removed.vertices[(corner + 1) % 3]));
+                removed.outside = {};
+                removed.removed = true;
+            }
+            for (auto [from, to] : horizon) addFace(from, to, eye);
+            for (uint32_t point : orphans) assign(point, firstFace);
+        }
+
+        // Keep the points the hull uses, with the edges between them as adjacency.
+        std::vector<uint32_t> remap(points.size(), ~0u);
+        for (const Face& face : faces)
+        {
+            if (face.removed) continue;
+            for (uint32_t vertex : face.vertices)
+            {
+                if (remap[vertex] != ~0u) continue;
+                remap[vertex] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(points[vertex]);
+            }
+        }
+        neighbourOffsets.assign(vertices.size() + 1, 0);
+        for (const Face& face : faces)
+        {
+            if (face.removed) continue;
+            for (uint32_t vertex : face.vertices) ++neighbourOffsets[remap[vertex] + 1];
+        }
+        for (size_t vertex = 0; vertex < vertices.size(); ++vertex) neighbourOffsets[vertex + 1] += neighbourOffsets[vertex];
+        neighbours.resize(neighbourOffsets.back());
+        std::vector<uint32_t> filled(neighbourOffsets.begin(), neighbourOffsets.end() - 1);
+
+        // Every edge shows up once in each direction over the faces, one of them per end is enough.
+        // Mass properties of the solid sum over tetrahedra from the origin to every face, then move to the centroid.
+        float volume = 0.0f;
+        Vector3 centroid = Vector3(0.0f);
+        Matrix3 covariance = Matrix3(0.0f);
+        auto outer = [](const Vector3& a, const Vector3& b) { return Matrix3(a * b.x, a * b.y, a * b.z); };
+        for (const Face& face : faces)
+        {
+            if (face.removed) continue;
+            for (size_t corner = 0; corner < 3; ++corner) neighbours[filled[remap[face.vertices[corner]]]++] = remap[face.vertices[(corner + 1) % 3]];
+
+            const Vector3& p = points[face.vertices[0]];
+            const Vector3& q = points[face.vertices[1]];
+            const Vector3& r = points[face.vertices[2]];
+            float determinant = Dot(p, Cross(q, r));
+            volume += determinant / 6.0f;
+            centroid += (p + q + r) * (determinant / 24.0f);
+            covariance += (outer(p, p) + outer(q, q) + outer(r, r) + outer(p + q + r, p + q + r)) * (determinant / 120.0f);
+        }
+        centroid /= volume;
+        covariance = covariance - outer(centroid, centroid) * volume;
+        inertia = (Matrix3(covariance[0][0] + covariance[1][1] + covariance[2][2]) - covariance) / volume;
+    }
+    ConvexHullCollider::ConvexHullCollider(const std::string& path) : Collider(Shape::Mesh)
+    {
+        auto iterator = s_Cache.find(path);
+        if (iterator != s_Cache.end() && (mp_Hull = iterator->second.lock())) return;
+
+        std::vector<unsigned int> indices;
+        std::vector<VertexP3T2N3> vertices;
+        if (!Utilities::LoadOBJFile(path, vertices, indices)) throw std::runtime_error("Could not load mesh file.");
+        std::vector<Vector3> points;
+        points.reserve(vertices.size());
+        for (const VertexP3T2N3& vertex : vertices) points.push_back(vertex.position);
+        mp_Hull = std::make_shared<const Hull>(std::move(points));
+        s_Cache[path] = mp_Hull;
+    }
+    ConvexHullCollider::ConvexHullCollider(const std::vector<Vector3>& points) : Collider(Shape::Mesh), mp_Hull(std::make_shared<const Hull>(points)) {}
+    size_t ConvexHullCollider::GetVertexCount() const { return mp_Hull->vertices.size(); }
+    Matrix3 ConvexHullCollider::GetInertiaTensor(float mass) const { return mp_Hull->inertia * mass; }
+
+    TriangleCollider::TriangleCollider(const Vector3& a, const Vector3& b, const Vector3& c) : Collider(Shape::Triangle), m_Vertices{ a, b, c } {}
+    const Vector3& TriangleCollider::GetVertex(size_t index) const { return m_Vertices[index]; }
+    Matrix3 TriangleCollider::GetInertiaTensor(float mass) const
+    {
+        // Thin plate about its centroid, the covariance of a triangle is a twelfth of the sum of its vertices' outer products.
+        Vector3 centroid = (m_Vertices[0] + m_Vertices[1] + m_Vertices[2]) / 3.0f;
+        Matrix3 covariance = Matrix3(0.0f);
+        for (const Vector3& vertex : m_Vertices)
+        {
+            Vector3 offset = vertex - centroid;
+            covariance += Matrix3(offset * offset.x, offset * offset.y, offset * offset.z) * (mass / 12.0f);
+        }
+        return Matrix3(covariance[0][0] + covariance[1][1] + covariance[2][2]) - covariance;
+    }
+
+    std::unordered_map<std::string, std::weak_ptr<const TriangleMeshCollider::Tree>> TriangleMeshCollider::s_Cache;
+    TriangleMeshCollider::Tree::Tree(const std::vector<Vector3>& positions, const std::vector<uint32_t>& indices)
+    {
+        // Degenerate triangles can't be touched, they're left out.
+        struct Triangle
+        {
+            Vector3 vertices[3];
+            Vector3 centroid;
+            Bounds bounds;
+        };
+        std::vector<Triangle> triangles;
+        triangles.reserve(indices.size() / 3);
+        for (size_t index = 0; index + 2 < indices.size(); index += 3)
+        {
+            Triangle triangle;
+            for (size_t vertex = 0; vertex < 3; ++vertex) triangle.vertices[vertex] = positions[indices[index + vertex]];
+            if (LengthSquared(Cross(triangle.vertices[1] - triangle.vertices[0], triangle.vertices[2] - triangle.vertices[0])) <= 1e-20f) continue;
+            triangle.centroid = (triangle.vertices[0] + triangle.vertices[1] + triangle.vertices[2]) / 3.0f;
+            triangle.bounds = Bounds(triangle.vertices[0], triangle.vertices[0]);
+            for (size_t vertex = 1; vertex < 3; ++vertex) triangle.bounds = Merged(triangle.bounds, Bounds(triangle.vertices[vertex], triangle.vertices[vertex]));
+            triangles.push_back(triangle);
+        }
+        if (triangles.empty()) throw std::runtime_error("Could not build triangle mesh without triangles.");
+        triangleCount = triangles.size();
+
+        // Top down over ranges of the triangle order. The first child is built right after its parent, the second one patches the parent's offset when its turn comes.
+        struct Range
+        {
+            uint32_t begin;
+            uint32_t end;
+            uint32_t parent;
+            uint32_t depth;
+        };
+        constexpr size_t binCount = 16;
+        std::vector<uint32_t> order(triangles.size());
+        for (uint32_t index = 0; index < order.size(); ++index) order[index] = index;
+        std::vector<Range> ranges = { { 0, static_cast<uint32_t>(order.size()), ~0u, 0 } };
+        while (!ranges.empty())
+        {
+            Range range = ranges.back();
+            ranges.pop_back();
+            uint32_t index = static_cast<uint32_t>(nodes.size());
+            if (range.parent != ~0u) nodes[range.parent].offset = index;
+
+            Bounds bounds = triangles[order[range.begin]].bounds;
+            Bounds centroids = Bounds(triangles[order[range.begin]].centroid, triangles[order[range.begin]].centroid);
+            for (uint32_t position = range.begin + 1; position < range.end; ++position)
+            {
+                const Triangle& triangle = triangles[order[position]];
+                bounds = Merged(bounds, triangle.bounds);
+                centroids = Merged(centroids, Bounds(triangle.centroid, triangle.centroid));
+            }
+            nodes.push_back({ bounds.min, 0, bounds.max, 0 });
+
+            uint32_t count = range.end - range.begin;
+            if (count <= LaneCount)
+            {
+                TrianglePacket packet;
+                for (size_t lane = 0; lane < LaneCount; ++lane)
+                {
+                    const Triangle& triangle = triangles[order[range.begin + (lane < count ? lane : 0)]];
+                    for (size_t vertex = 0; vertex < 3; ++vertex)
+                    {
+                        for (size_t component = 0; component < 3; ++component) packet.vertices[vertex][component][lane] = triangle.vertices[vertex][component];
+                    }
+                }
+                nodes[index].offset = static_cast<uint32_t>(packets.size());
+                nodes[index].count = count;
+                packets.push_back(packet);
+                continue;
+            }
+
+            // Binned surface area heuristic over the centroids, leaves never take more than a packet so every range above that is split.
+            size_t bestAxis = 3;
+            size_t bestBin = 0;
+            float bestCost = std::numeric_limits<float>::infinity();
+            for (size_t axis = 0; axis < 3 && range.depth < s_MaxDepth / 2; ++axis)
+            {
+                float extent = centroids.max[axis] - centroids.min[axis];
+                if (extent <= 1e-12f) continue;
+                float scale = binCount / extent;
+                auto bin = [&](const Triangle& triangle) { return std::min(static_cast<size_t>((triangle.centroid[axis] - centroids.min[axis]) * scale), binCount - 1); };
+
+                std::array<Bounds, binCount> binBounds;
+                std::array<uint32_t, binCount> binCounts = {};
+                for (uint32_t position = range.begin; position < range.end; ++position)
+                {
+                    const Triangle& triangle = triangles[order[position]];
+                    size_t slot = bin(triangle);
+                    binBounds[slot] = binCounts[slot]++ ? Merged(binBounds[slot], triangle.bounds) : triangle.bounds;
+                }
+
+                // Areas and counts left of every split from one sweep, the right side's from another.
+                std::array<float, binCount> leftCosts;
+                Bounds side;
+                uint32_t sideCount = 0;
+                for (size_t split = 0; split + 1 < binCount; ++split)
+                {
+                    if (binCounts[split]) side = sideCount ? Merged(side, binBounds[split]) : binBounds[split];
+                    sideCount += binCounts[split];
+                    leftCosts[split] = sideCount ? side.GetSurfaceArea() * sideCount : std::numeric_limits<float>::infinity();
+                }
+                sideCount = 0;
+                for (size_t split = binCount - 1; split > 0; --split)
+                {
+                    if (binCounts[split]) side = sideCount ? Merged(side, binBounds[split]) : binBounds[split];
+                    sideCount += binCounts[split];
+                    if (sideCount == 0) continue;
+                    float cost = leftCosts[split - 1] + side.GetSurfaceArea() * sideCount;
+                    if (cost >= bestCost) continue;
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = split - 1;
+                }
+            }
+
+            uint32_t middle;
+            if (bestAxis < 3)
+            {
+                float scale = binCount / (centroids.max[bestAxis] - centroids.min[bestAxis]);
+                auto left = [&](uint32_t triangle) { return std::min(static_cast<size_t>((triangles[triangle].centroid[bestAxis] - centroids.min[bestAxis]) * scale), binCount - 1) <= bestBin; };
+                middle = static_cast<uint32_t>(std::partition(order.begin() + range.begin, order.begin() + range.end, left) - order.begin());
+            }
+            else
+            {
+                // Coincident centroids or a tree already deep enough, halve along the longest side so the depth stays bounded.
+                size_t axis = 0;
+                Vector3 size = centroids.max - centroids.min;
+                if (size.y > size[axis]) axis = 1;
+                if (size.z > size[axis]) axis = 2;
+                middle = range.begin + count / 2;
+                std::nth_element(order.begin() + range.begin, order.begin() + middle, order.begin() + range.end, [&](uint32_t a, uint32_t b) { return triangles[a].centroid[axis] < triangles[b].centroid[axis]; });
+            }
+            ranges.push_back({ middle, range.end, index, range.depth + 1 });
+            ranges.push_back({ range.begin, middle, ~0u, range.depth + 1 });
+        }
+    }
+    TriangleMeshCollider::TriangleMeshCollider(const std::string& path) : Collider(Shape::TriangleMesh)
+    {
+        auto iterator = s_Cache.find(path);
+        if (iterator != s_Cache.end() && (mp_Tree = iterator->second.lock())) return;
+
+        std::vector<unsigned int> indices;
+        std::vector<VertexP3T2N3> vertices;
+        if (!Utilities::LoadOBJFile(path, vertices, indices)) throw std::runtime_error("Could not load mesh file.");
+        std::vector<Vector3> positions;
+        positions.reserve(vertices.size());
+        for (const VertexP3T2N3& vertex : vertices) positions.push_back(vertex.position);
+        mp_Tree = std::make_shared<const Tree>(positions, std::vector<uint32_t>(indices.begin(), indices.end()));
+        s_Cache[path] = mp_Tree;
+    }
+    TriangleMeshCollider::TriangleMeshCollider(const std::vector<Vector3>& positions, const std::vector<uint32_t>& indices) : Collider(Shape::TriangleMesh), mp_Tree(std::make_shared<const Tree>(positions, indices)) {}
+    size_t TriangleMeshCollider::GetTriangleCount() const { return mp_Tree->triangleCount; }
+    size_t TriangleMeshCollider::GetNodeCount() const { return mp_Tree->nodes.size(); }
+    Matrix3 TriangleMeshCollider::GetInertiaTensor(float mass) const
+    {
+        // Never moves, the box around it is as good as anything.
+        Vector3 size = mp_Tree->nodes[0].max - mp_Tree->nodes[0].min;
+        return Matrix3(
+            mass * (size.y * size.y + size.z * size.z) / 12.0f, 0.0f, 0.0f,
+            0.0f, mass * (size.x * size.x + size.z * size.z) / 12.0f, 0.0f,
+            0.0f, 0.0f, mass * (size.x * size.x + size.y * size.y) / 12.0f
+        );
+    }
+
+    HeightfieldCollider::HeightfieldCollider(size_t columns, size_t rows, std::vector<uint16_t> samples, const Vector3& scale) : Collider(Shape::Heightfield), m_Columns(columns), m_Rows(rows), m_Scale(scale)
+    {
+        if (columns < 2 || rows < 2 || samples.size() != columns * rows) throw std::runtime_error("Could not build heightfield from mismatched samples.");
+        m_Origin = Vector3(-0.5f * (columns - 1) * scale.x, -0.5f * (rows - 1) * scale.y, 0.0f);
+        auto [low, high] = std::minmax_element(samples.begin(), samples.end());
+        m_MinHeight = *low * scale.z;
+        m_MaxHeight = *high * scale.z;
+        mp_Samples = std::make_shared<const std::vector<uint16_t>>(std::move(samples));
+    }
+    HeightfieldCollider::HeightfieldCollider(size_t columns, size_t rows, const std::vector<float>& heights, const Vector3& scale) : Collider(Shape::Heightfield), m_Columns(columns), m_Rows(rows), m_Scale(scale)
+    {
+        if (columns < 2 || rows < 2 || heights.size() != columns * rows) throw std::runtime_error("Could not build heightfield from mismatched samples.");
+        m_Origin = Vector3(-0.5f * (columns - 1) * scale.x, -0.5f * (rows - 1) * scale.y, 0.0f);
+
+        // Heights are quantized over their own range, one step is a 65535th of it.
+        auto [low, high] = std::minmax_element(heights.begin(), heights.end());
+        m_MinHeight = *low * scale.z;
+        m_MaxHeight = *high * scale.z;
+        m_Origin.z = m_MinHeight;
+        m_Scale.z = Max(m_MaxHeight - m_MinHeight, 1e-6f) / std::numeric_limits<uint16_t>::max();
+        std::vector<uint16_t> samples(heights.size());
+        for (size_t index = 0; index < heights.size(); ++index) samples[index] = static_cast<uint16_t>(std::lround((heights[index] * scale.z - m_MinHeight) / m_Scale.z));
+        mp_Samples = std::make_shared<const std::vector<uint16_t>>(std::move(samples));
+    }
+    size_t HeightfieldCollider::GetColumnCount() const { return m_Columns; }
+    size_t HeightfieldCollider::GetRowCount() const { return m_Rows; }
+    float HeightfieldCollider::GetHeight(size_t column, size_t row) const { return m_Origin.z + (*mp_Samples)[row * m_Columns + column] * m_Scale.z; }
+    Matrix3 HeightfieldCollider::GetInertiaTensor(float mass) const
+    {
+        // Never moves either, the box around it will do.
+        Vector3 size = Vector3(-2.0f * m_Origin.x, -2.0f * m_Origin.y, m_MaxHeight - m_MinHeight);
+        return Matrix3(
+            mass * (size.y * size.y + size.z * size.z) / 12.0f, 0.0f, 0.0f,
+            0.0f, mass * (size.x * size.x + size.z * size.z) / 12.0f, 0.0f,
+            0.0f, 0.0f, mass * (size.x * size.x + size.y * size.y) / 12.0f
+        );
+    }
+
+    Bounds ColliderVariant::GetWorldBounds(const Frame& frame) const
+    {
+        Bounds bounds;
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            Vector3 direction = Vector3(0.0f);
+            direction[axis] = 1.0f;
+            bounds.max[axis] = GetWorldSupport(frame, direction)[axis];
+            bounds.min[axis] = GetWorldSupport(frame, -direction)[axis];
+        }
+        return bounds;
+    }
+    Matrix3 ColliderVariant::GetInertiaTensor(float mass) const { return std::visit([mass](const auto& collider) { return collider.GetInertiaTensor(mass); }, m_Collider); }
+    Matrix3 ColliderVariant::GetInverseInertiaTensor(float mass) const { return Inversed(GetInertiaTensor(mass)); }
 }
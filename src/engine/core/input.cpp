@@ -46,12 +46,13 @@ namespace Engine
             }
         }
 
+        // Physics steps at its own fixed rate, so push with the momentum of this frame rather than a force that waits for the next step.
         for (auto [handle, physics] : world.View<Physics, Controllable>())
         {
-            if (window.IsKeyPressed(Key::UpArrow) || window.IsKeyHeld(Key::UpArrow)) physics.ApplyForce(physics.GetMass() * 50.0f * Vector3(0.0f, 1.0f, 0.0f));
-            if (window.IsKeyPressed(Key::DownArrow) || window.IsKeyHeld(Key::DownArrow)) physics.ApplyForce(physics.GetMass() * 50.0f * Vector3(0.0f, -1.0f, 0.0f));
-            if (window.IsKeyPressed(Key::RightArrow) || window.IsKeyHeld(Key::RightArrow)) physics.ApplyForce(physics.GetMass() * 50.0f * Vector3(1.0f, 0.0f, 0.0f));
-            if (window.IsKeyPressed(Key::LeftArrow) || window.IsKeyHeld(Key::LeftArrow)) physics.ApplyForce(physics.GetMass() * 50.0f * Vector3(-1.0f, 0.0f, 0.0f));
+            if (window.IsKeyPressed(Key::UpArrow) || window.IsKeyHeld(Key::UpArrow)) physics.ApplyLinearImpulse(physics.GetMass() * 50.0f * deltaTime * Vector3(0.0f, 1.0f, 0.0f));
+            if (window.IsKeyPressed(Key::DownArrow) || window.IsKeyHeld(Key::DownArrow)) physics.ApplyLinearImpulse(physics.GetMass() * 50.0f * deltaTime * Vector3(0.0f, -1.0f, 0.0f));
+            if (window.IsKeyPressed(Key::RightArrow) || window.IsKeyHeld(Key::RightArrow)) physics.ApplyLinearImpulse(physics.GetMass() * 50.0f * deltaTime * Vector3(1.0f, 0.0f, 0.0f));
+            if (window.IsKeyPressed(Key::LeftArrow) || window.IsKeyHeld(Key::LeftArrow)) physics.ApplyLinearImpulse(physics.GetMass() * 50.0f * deltaTime * Vector3(-1.0f, 0.0f, 0.0f));
         }
     }
 }
\ No newline at end of file
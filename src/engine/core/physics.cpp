@@ -9,7 +9,7 @@ namespace Engine
         if (m_Stationary) return;
         m_Mass = mass;
         m_InverseMass = 1.0f / mass;
-        m_CachedInertiaTensor = m_Collider->GetInertiaTensor(mass);
+        m_CachedInertiaTensor = m_Collider.GetInertiaTensor(mass);
         m_CachedInverseInertiaTensor = Inversed(m_CachedInertiaTensor);
     }
     float Physics::GetDrag() const { return m_Drag; }
@@ -18,16 +18,53 @@ namespace Engine
     void Physics::SetFriction(float friction) { m_Friction = friction; }
     float Physics::GetRestitution() const { return m_Restitution; }
     void Physics::SetRestitution(float restitution) { m_Restitution = restitution; }
-    void Physics::ApplyForce(const Vector3& force) { m_ForceAccumulator += force; }
-    void Physics::ApplyTorque(const Vector3& torque) { m_TorqueAccumulator += torque; }
-    void Physics::ApplyLinearImpulse(const Vector3& impulse) { m_Velocity += impulse * m_InverseMass; }
-    void Physics::ApplyAngularImpulse(const Vector3& impulse, const Matrix3& worldInverseInertiaTensor) { m_AngularVelocity += worldInverseInertiaTensor * impulse; }
+    void Physics::ApplyForce(const Vector3& force)
+    {
+        m_ForceAccumulator += force;
+        Wake();
+    }
+    void Physics::ApplyTorque(const Vector3& torque)
+    {
+        m_TorqueAccumulator += torque;
+        Wake();
+    }
+    void Physics::ApplyLinearImpulse(const Vector3& impulse)
+    {
+        m_Velocity += impulse * m_InverseMass;
+        Wake();
+    }
+    void Physics::ApplyAngularImpulse(const Vector3& impulse, const Matrix3& worldInverseInertiaTensor)
+    {
+        m_AngularVelocity += worldInverseInertiaTensor * impulse;
+        Wake();
+    }
     void Physics::ResetAccumulators()
     {
         m_ForceAccumulator = Vector3(0.0f);
         m_TorqueAccumulator = Vector3(0.0f);
     }
+    Vector3 Physics::GetAccumulatedForce() const { return m_ForceAccumulator; }
+    Vector3 Physics::GetAccumulatedTorque() const { return m_TorqueAccumulator; }
     bool Physics::IsStationary() const { return m_Stationary; }
+    bool Physics::IsSleeping() const { return m_Sleeping; }
+    bool Physics::IsContinuous() const { return m_Continuous; }
+    void Physics::SetContinuous(bool continuous) { m_Continuous = continuous; }
+    void Physics::Sleep()
+    {
+        if (m_Stationary) return;
+        m_Sleeping = true;
+        m_Velocity = Vector3(0.0f);
+        m_AngularVelocity = Vector3(0.0f);
+        ResetAccumulators();
+    }
+    void Physics::Wake()
+    {
+        if (!m_Sleeping) return;
+        m_Sleeping = false;
+        m_SleepTime = 0.0f;
+    }
+    float Physics::GetSleepTime() const { return m_SleepTime; }
+    void Physics::SetSleepTime(float sleepTime) { m_SleepTime = sleepTime; }
     void Physics::Integrate(float deltaTime, const Matrix3& worldInverseInertiaTensor)
     {
         m_Velocity += m_ForceAccumulator * m_InverseMass * deltaTime;
@@ -36,9 +73,19 @@ namespace Engine
         m_AngularVelocity += worldInverseInertiaTensor * m_TorqueAccumulator * deltaTime;
         m_AngularVelocity *= 1.0f - m_Drag * deltaTime;
     }
-    Collider& Physics::GetCollider() const { return *m_Collider; }
+    const ColliderVariant& Physics::GetCollider() const { return m_Collider; }
     Vector3 Physics::GetVelocity() const { return m_Velocity; }
+    void Physics::SetVelocity(const Vector3& velocity)
+    {
+        m_Velocity = velocity;
+        if (LengthSquared(velocity) > 0.0f) Wake();
+    }
     Vector3 Physics::GetAngularVelocity() const { return m_AngularVelocity; }
+    void Physics::SetAngularVelocity(const Vector3& angularVelocity)
+    {
+        m_AngularVelocity = angularVelocity;
+        if (LengthSquared(angularVelocity) > 0.0f) Wake();
+    }
     Matrix3 Physics::GetInertiaTensor() const { return m_CachedInertiaTensor; }
     Matrix3 Physics::GetInverseInertiaTensor() const { return m_CachedInverseInertiaTensor; }
 }
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <engine/core/pool.hpp>
+
+namespace Engine
+{
+    static thread_local size_t s_ThreadIndex = 0;
+
+    ThreadPool::ThreadPool(size_t threadCount)
+    {
+        for (size_t index = 1; index < threadCount; ++index) m_Workers.emplace_back(&ThreadPool::Work, this, index);
+    }
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Stopping = true;
+        }
+        m_Start.notify_all();
+        for (std::thread& worker : m_Workers) worker.join();
+    }
+    size_t ThreadPool::GetThreadCount() const { return m_Workers.size() + 1; }
+    size_t ThreadPool::GetThreadIndex() { return s_ThreadIndex; }
+
+    void ThreadPool::Work(size_t threadIndex)
+    {
+        s_ThreadIndex = threadIndex;
+        uint64_t generation = 0;
+        while (true)
+        {
+            {
+                std::unique_lock lock(m_Mutex);
+                m_Start.wait(lock, [this, generation]() { return m_Stopping || m_Generation != generation; });
+                if (m_Stopping) return;
+                generation = m_Generation;
+            }
+            Drain();
+            {
+                std::lock_guard lock(m_Mutex);
+                if (--m_Active == 0) m_Done.notify_one();
+            }
+        }
+    }
+    void ThreadPool::Drain()
+    {
+        for (size_t begin = m_Next.fetch_add(m_Grain); begin < m_Count; begin = m_Next.fetch_add(m_Grain))
+        {
+            mp_Task(mp_Context, begin, std::min(begin + m_Grain, m_Count));
+        }
+    }
+    void ThreadPool::Run(Task task, void* context, size_t count, size_t grain)
+    {
+        if (count == 0) return;
+        grain = std::max(grain, static_cast<size_t>(1));
+
+        // Loops that fit in one block aren't worth waking anyone for.
+        if (m_Workers.empty() || count <= grain)
+        {
+            task(context, 0, count);
+            return;
+        }
+
+        {
+            std::lock_guard lock(m_Mutex);
+            mp_Task = task;
+            mp_Context = context;
+            m_Count = count;
+            m_Grain = grain;
+            m_Next = 0;
+            m_Active = m_Workers.size();
+            ++m_Generation;
+        }
+        m_Start.notify_all();
+        Drain();
+
+        std::unique_lock lock(m_Mutex);
+        m_Done.wait(lock, [this]() { return m_Active == 0; });
+    }
+}
@@ -28,7 +28,7 @@ namespace Engine
         m_ShadowMap.SetCompareMode(Texture::CompareMode::ReferenceToTexture);
         m_ShadowMap.SetCompareFunction(Texture::CompareFunction::LessOrEqual);
     }
-    void Renderer::Render(World& world, Window& window)
+    void Renderer::Render(World& world, Window& window, float alpha)
     {
         Object cameraObject = world.GetActiveCamera();
         if (!cameraObject.IsValid()) return;
@@ -49,7 +49,7 @@ namespace Engine
         m_LightTransform.TranslateTo(cameraTransform.GetPosition() + Vector3(0.0f, 0.0f, 10.0f));
         for (auto [handle, transform, mesh, texture] : world.View<Transform, Mesh, Texture>())
         {
-            vertexPositionTransformationMatrix = m_Light.GetProjectionMatrix() * m_LightTransform.GetInverseWorldMatrix() * transform.GetWorldMatrix();
+            vertexPositionTransformationMatrix = m_Light.GetProjectionMatrix() * m_LightTransform.GetInverseWorldMatrix() * Interpolated(transform, alpha).GetWorldMatrix();
             m_ShadowShader.SetUniform("vertexPositionTransformationMatrix", vertexPositionTransformationMatrix);
             m_ShadowShader.Draw(mesh);
         }
@@ -78,7 +78,7 @@ namespace Engine
         for (auto [handle, transform, mesh, texture] : world.View<Transform, Mesh, Texture>())
         {
             texture.Bind(0);
-            m_Shader.SetUniform("world", transform.GetWorldMatrix());
+            m_Shader.SetUniform("world", Interpolated(transform, alpha).GetWorldMatrix());
             m_Shader.Draw(mesh);
         }
 
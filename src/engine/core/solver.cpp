@@ -1,3 +1,6 @@
+#include <bit>
+#include <chrono>
+#include <numeric>
 #include <engine/core/solver.hpp>
 
 // #include <string>
@@ -8,12 +11,40 @@ namespace Engine
     Solver::Solver(float gravity) : m_Gravity(gravity) {}
     float Solver::GetGravity() const { return m_Gravity; }
     void Solver::SetGravity(float gravity) { m_Gravity = gravity; }
+    float Solver::GetFixedTimeStep() const { return m_FixedTimeStep; }
+    void Solver::SetFixedTimeStep(float fixedTimeStep) { m_FixedTimeStep = fixedTimeStep; }
+    size_t Solver::GetMaxSteps() const { return m_MaxSteps; }
+    void Solver::SetMaxSteps(size_t maxSteps) { m_MaxSteps = maxSteps; }
+    size_t Solver::GetSubsteps() const { return m_Substeps; }
+    void Solver::SetSubsteps(size_t substeps) { m_Substeps = std::max(substeps, static_cast<size_t>(1)); }
+    const Broadphase::Statistics& Solver::GetBroadphaseStatistics() const { return mp_Broadphase->GetStatistics(); }
+    const Solver::Statistics& Solver::GetStatistics() const { return m_Statistics; }
+    Solver::EPAMode Solver::GetEPAMode() const { return m_EPAMode; }
+    void Solver::SetEPAMode(EPAMode mode) { m_EPAMode = mode; }
+    size_t Solver::GetVelocityIterations() const { return m_VelocityIterations; }
+    void Solver::SetVelocityIterations(size_t iterations) { m_VelocityIterations = iterations; }
+    size_t Solver::GetPositionIterations() const { return m_PositionIterations; }
+    void Solver::SetPositionIterations(size_t iterations) { m_PositionIterations = iterations; }
+    bool Solver::IsSleepEnabled() const { return m_SleepEnabled; }
+    void Solver::SetSleepEnabled(bool enabled) { m_SleepEnabled = enabled; }
+    bool Solver::IsBatchedGJKEnabled() const { return m_BatchedGJKEnabled; }
+    void Solver::SetBatchedGJKEnabled(bool enabled) { m_BatchedGJKEnabled = enabled; }
+    bool Solver::IsBatchedIntegrationEnabled() const { return m_BatchedIntegrationEnabled; }
+    void Solver::SetBatchedIntegrationEnabled(bool enabled) { m_BatchedIntegrationEnabled = enabled; }
+    size_t Solver::GetThreadCount() const { return mp_ThreadPool ? mp_ThreadPool->GetThreadCount() : 1; }
+    void Solver::SetThreadCount(size_t threadCount)
+    {
+        mp_ThreadPool.reset();
+        if (threadCount > 1) mp_ThreadPool = std::make_unique<ThreadPool>(threadCount);
+        m_NarrowphaseBuffers.resize(GetThreadCount());
+    }
+    Solver::Statistics& Solver::GetThreadStatistics() { return m_NarrowphaseBuffers[ThreadPool::GetThreadIndex()].statistics; }
 
-    Solver::Support Solver::GetSupport(const Collider& colliderA, const Transform& transformA, const Collider& colliderB, const Transform& transformB, Vector3 direction)
+    Solver::Support Solver::GetSupport(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB, Vector3 direction, SupportHints& hints)
     {
         Support support;
-        support.pointFromA = colliderA.GetWorldSupport(transformA, direction);
-        support.pointFromB = colliderB.GetWorldSupport(transformB, -direction);
+        support.pointFromA = colliderA.GetWorldSupport(frameA, direction, hints.a);
+        support.pointFromB = colliderB.GetWorldSupport(frameB, -direction, hints.b);
         support.point = support.pointFromA - support.pointFromB;
         return support;
     }
@@ -43,19 +74,34 @@ namespace Engine
         return Vector3(u, v, w);
     }
 
-    Solver::CollisionInfo Solver::GJK(const Collider& colliderA, const Transform& transformA, const Collider& colliderB, const Transform& transformB)
+    Solver::CollisionInfo Solver::GJK(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB)
+    {
+        Vector3 direction = frameA.position - frameB.position + Vector3(1e-6f);
+        SupportHints hints;
+        return GJK(colliderA, frameA, colliderB, frameB, direction, hints);
+    }
+    Solver::CollisionInfo Solver::GJK(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB, Vector3& direction, SupportHints& hints)
     {
         Simplex simplex;
+        ++GetThreadStatistics().gjkQueries;
 
-        Vector3 direction = transformA.GetPosition() - transformB.GetPosition() + Vector3(1e-6f);
-        Support support = GetSupport(colliderA, transformA, colliderB, transformB, direction);
+        Support support = GetSupport(colliderA, frameA, colliderB, frameB, direction, hints);
+
+        // The first support point already falls short of the origin, the direction separates the shapes.
+        if (Dot(support.point, direction) < 0.0f)
+        {
+            CollisionInfo info;
+            info.status = CollisionInfo::Status::Separated;
+            return info;
+        }
 
         simplex.Push(support);
         direction = -support.point;
 
         for (size_t iteration = 0; iteration < s_MaxGJKIterations; ++iteration)
         {
-            support = GetSupport(colliderA, transformA, colliderB, transformB, direction);
+            ++GetThreadStatistics().gjkIterations;
+            support = GetSupport(colliderA, frameA, colliderB, frameB, direction, hints);
 
             if (!SameDirection(support.point, direction))
             {
@@ -66,7 +112,7 @@ namespace Engine
 
             simplex.Push(support);
 
-            if (NextSimplex(simplex, direction)) return EPA(simplex, colliderA, transformA, colliderB, transformB);
+            if (NextSimplex(simplex, direction)) return EPA(simplex, colliderA, frameA, colliderB, frameB, hints);
         }
 
         CollisionInfo info;
@@ -182,23 +228,209 @@ namespace Engine
         return true;
     }
     
-    Solver::CollisionInfo Solver::EPA(const Simplex& simplex, const Collider& colliderA, const Transform& transformA, const Collider& colliderB, const Transform& transformB)
+    bool Solver::IsRoundedBox(const ColliderVariant& collider)
+    {
+        Collider::Shape shape = collider.GetShape();
+        return shape == Collider::Shape::Cube || shape == Collider::Shape::Plane || shape == Collider::Shape::Sphere || shape == Collider::Shape::Capsule;
+    }
+    void Solver::SetRoundedBox(RoundedBoxes& boxes, size_t lane, const ColliderVariant& collider, const Frame& frame)
+    {
+        Vector3 halfExtents = Vector3(0.0f);
+        float radius = 0.0f;
+        switch (collider.GetShape())
+        {
+            case Collider::Shape::Cube: halfExtents = Vector3(collider.Get<CubeCollider>().GetHalfLength()); break;
+            case Collider::Shape::Plane: halfExtents = Vector3(collider.Get<PlaneCollider>().GetHalfLength(), collider.Get<PlaneCollider>().GetHalfLength(), 0.0f); break;
+            case Collider::Shape::Capsule:
+                halfExtents = Vector3(0.0f, 0.0f, collider.Get<CapsuleCollider>().GetHalfLength());
+                radius = collider.Get<CapsuleCollider>().GetRadius();
+                break;
+            default: radius = collider.Get<SphereCollider>().GetRadius(); break;
+        }
+        for (size_t column = 0; column < 3; ++column)
+        {
+            boxes.position[column][lane] = frame.position[column];
+            boxes.halfExtents[column][lane] = halfExtents[column];
+            for (size_t component = 0; component < 3; ++component) boxes.linear[column][component][lane] = frame.linear[column][component];
+        }
+        boxes.radius[lane] = radius;
+    }
+    Vector3Lanes Solver::GetSupport(const RoundedBoxes& boxes, const Vector3Lanes& direction)
+    {
+        // Same as the scalar supports, the direction goes to local space through the transposed linear part and the point comes back through it.
+        Vector3Lanes columns[3];
+        FloatLanes local[3];
+        for (size_t column = 0; column < 3; ++column)
+        {
+            columns[column] = { Load(boxes.linear[column][0]), Load(boxes.linear[column][1]), Load(boxes.linear[column][2]) };
+            local[column] = Dot(direction, columns[column]);
+        }
+        FloatLanes length = Max(SquareRoot(local[0] * local[0] + local[1] * local[1] + local[2] * local[2]), FloatLanes(1e-12f));
+        FloatLanes scale = Load(boxes.radius) / length;
+        Vector3Lanes point = { Load(boxes.position[0]), Load(boxes.position[1]), Load(boxes.position[2]) };
+        for (size_t column = 0; column < 3; ++column)
+        {
+            FloatLanes halfExtent = Load(boxes.halfExtents[column]);
+            point = point + columns[column] * (Select(local[column] >= FloatLanes(0.0f), halfExtent, -halfExtent) + local[column] * scale);
+        }
+        return point;
+    }
+    Vector3Lanes Solver::GetClosestPoint(const Vector3Lanes& point, const Vector3Lanes& a, const Vector3Lanes& b, const Vector3Lanes& c)
+    {
+        // The scalar closest point on a triangle with every Voronoi region worked out, its early outs become selects applied from the last region to the first.
+        FloatLanes zero = FloatLanes(0.0f);
+        FloatLanes tiny = FloatLanes(1e-12f);
+        Vector3Lanes ab = b - a;
+        Vector3Lanes ac = c - a;
+        FloatLanes d1 = Dot(ab, point - a);
+        FloatLanes d2 = Dot(ac, point - a);
+        FloatLanes d3 = Dot(ab, point - b);
+        FloatLanes d4 = Dot(ac, point - b);
+        FloatLanes d5 = Dot(ab, point - c);
+        FloatLanes d6 = Dot(ac, point - c);
+        FloatLanes va = d3 * d6 - d5 * d4;
+        FloatLanes vb = d5 * d2 - d1 * d6;
+        FloatLanes vc = d1 * d4 - d3 * d2;
+
+        FloatLanes denominator = FloatLanes(1.0f) / Max(va + vb + vc, tiny);
+        Vector3Lanes closest = a + ab * (vb * denominator) + ac * (vc * denominator);
+        closest = Select((va <= zero) & (d4 - d3 >= zero) & (d5 - d6 >= zero), b + (c - b) * ((d4 - d3) / Max((d4 - d3) + (d5 - d6), tiny)), closest);
+        closest = Select((vb <= zero) & (d2 >= zero) & (d6 <= zero), a + ac * (d2 / Max(d2 - d6, tiny)), closest);
+        closest = Select((d6 >= zero) & (d5 <= d6), c, closest);
+        closest = Select((vc <= zero) & (d1 >= zero) & (d3 <= zero), a + ab * (d1 / Max(d1 - d3, tiny)), closest);
+        closest = Select((d3 >= zero) & (d4 <= d3), b, closest);
+        return Select((d1 <= zero) & (d2 <= zero), a, closest);
+    }
+    uint32_t Solver::BatchGJK(GJKBatch& batch)
+    {
+        // The scalar GJK's boolean part run on every lane at once, each step of the simplex update becomes a masked select.
+        // Lanes that have an answer drop out of the active mask and keep their state from then on.
+        // Points on A are carried along with the simplex, so EPA can start from it.
+        FloatLanes zero = FloatLanes(0.0f);
+        MaskLanes active = FromBits((1u << batch.count) - 1);
+        MaskLanes overlapping = FromBits(0);
+        MaskLanes contained = FromBits(0);
+        Vector3Lanes direction = { Load(batch.direction[0]), Load(batch.direction[1]), Load(batch.direction[2]) };
+
+        Vector3Lanes fromA = GetSupport(batch.a, direction);
+        Vector3Lanes A = fromA - GetSupport(batch.b, -direction);
+        active = AndNot(active, Dot(A, direction) < zero);
+        Vector3Lanes B = A;
+        Vector3Lanes C = A;
+        Vector3Lanes D = A;
+        Vector3Lanes fromAA = fromA;
+        Vector3Lanes fromAB = fromA;
+        Vector3Lanes fromAC = fromA;
+        Vector3Lanes fromAD = fromA;
+        FloatLanes count = FloatLanes(1.0f);
+        direction = Select(active, -A, direction);
+
+        for (size_t iteration = 0; iteration < s_MaxGJKIterations && Any(active); ++iteration)
+        {
+            // The origin sits on the simplex, close enough to touching to leave to the full test.
+            MaskLanes degenerate = active & (LengthSquared(direction) < FloatLanes(1e-12f));
+            overlapping = overlapping | degenerate;
+            active = AndNot(active, degenerate);
+
+            fromA = GetSupport(batch.a, direction);
+            Vector3Lanes point = fromA - GetSupport(batch.b, -direction);
+            active = active & (Dot(point, direction) > zero);
+            D = Select(active, C, D);
+            C = Select(active, B, C);
+            B = Select(active, A, B);
+            A = Select(active, point, A);
+            fromAD = Select(active, fromAC, fromAD);
+            fromAC = Select(active, fromAB, fromAC);
+            fromAB = Select(active, fromAA, fromAB);
+            fromAA = Select(active, fromA, fromAA);
+            count = Select(active, Select(count == FloatLanes(4.0f), count, count + FloatLanes(1.0f)), count);
+            MaskLanes line = active & (count == FloatLanes(2.0f));
+
+            // Tetrahedron: keep the face the origin lies beyond, or stop when it is inside.
+            MaskLanes tetrahedron = active & (count == FloatLanes(4.0f));
+            Vector3Lanes AO = -A;
+            Vector3Lanes AB = B - A;
+            Vector3Lanes AC = C - A;
+            Vector3Lanes AD = D - A;
+            MaskLanes faceABC = tetrahedron & (Dot(Cross(AB, AC), AO) > zero);
+            MaskLanes faceACD = AndNot(tetrahedron & (Dot(Cross(AC, AD), AO) > zero), faceABC);
+            MaskLanes faceADB = AndNot(AndNot(tetrahedron & (Dot(Cross(AD, AB), AO) > zero), faceABC), faceACD);
+            MaskLanes inside = AndNot(AndNot(AndNot(tetrahedron, faceABC), faceACD), faceADB);
+            contained = contained | inside;
+            active = AndNot(active, inside);
+            Vector3Lanes faceB = Select(faceACD, C, Select(faceADB, D, B));
+            C = Select(faceACD, D, Select(faceADB, B, C));
+            B = faceB;
+            faceB = Select(faceACD, fromAC, Select(faceADB, fromAD, fromAB));
+            fromAC = Select(faceACD, fromAD, Select(faceADB, fromAB, fromAC));
+            fromAB = faceB;
+            count = Select(faceABC | faceACD | faceADB, FloatLanes(3.0f), count);
+
+            // Triangle: an edge region drops to a line, otherwise search above or below the face.
+            MaskLanes triangle = active & (count == FloatLanes(3.0f));
+            AB = B - A;
+            AC = C - A;
+            Vector3Lanes ABC = Cross(AB, AC);
+            MaskLanes outsideAC = triangle & (Dot(Cross(ABC, AC), AO) > zero);
+            MaskLanes edgeAC = outsideAC & (Dot(AC, AO) > zero);
+            MaskLanes outsideAB = AndNot(triangle, outsideAC) & (Dot(Cross(AB, ABC), AO) > zero);
+            MaskLanes face = AndNot(AndNot(triangle, outsideAC), outsideAB);
+            MaskLanes below = AndNot(face, Dot(ABC, AO) > zero);
+            direction = Select(edgeAC, Cross(Cross(AC, AO), AC), Select(face, Select(below, -ABC, ABC), direction));
+            Vector3Lanes triangleB = Select(edgeAC | below, C, B);
+            C = Select(below, B, C);
+            B = triangleB;
+            triangleB = Select(edgeAC | below, fromAC, fromAB);
+            fromAC = Select(below, fromAB, fromAC);
+            fromAB = triangleB;
+            MaskLanes toLine = AndNot(outsideAC, edgeAC) | outsideAB;
+            count = Select(edgeAC | toLine, FloatLanes(2.0f), count);
+            line = line | toLine;
+
+            // Line: search perpendicular to the segment towards the origin, or from A alone when the origin is behind it.
+            AB = B - A;
+            MaskLanes towards = line & (Dot(AB, AO) > zero);
+            MaskLanes behind = AndNot(line, towards);
+            direction = Select(towards, Cross(Cross(AB, AO), AB), Select(behind, AO, direction));
+            count = Select(behind, FloatLanes(1.0f), count);
+        }
+
+        // Lanes still running when the iterations run out are left to the full test.
+        overlapping = overlapping | active | contained;
+        const Vector3Lanes* vertices[4][2] = { { &A, &fromAA }, { &B, &fromAB }, { &C, &fromAC }, { &D, &fromAD } };
+        for (size_t vertex = 0; vertex < 4; ++vertex)
+        {
+            for (size_t part = 0; part < 2; ++part)
+            {
+                Store(batch.simplex[vertex][part][0], vertices[vertex][part]->x);
+                Store(batch.simplex[vertex][part][1], vertices[vertex][part]->y);
+                Store(batch.simplex[vertex][part][2], vertices[vertex][part]->z);
+            }
+        }
+        Store(batch.direction[0], direction.x);
+        Store(batch.direction[1], direction.y);
+        Store(batch.direction[2], direction.z);
+        batch.contained = ToBits(contained);
+        return ToBits(overlapping);
+    }
+
+    Solver::CollisionInfo Solver::EPA(const Simplex& simplex, const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB, SupportHints& hints)
     {
-        std::vector<Support> polytope;
-        polytope.reserve(64);
-        std::vector<Face> faces;
-        faces.reserve(64);
-        std::vector<std::pair<size_t, size_t>> uniqueEdges;
-        uniqueEdges.reserve(64);
+        ++GetThreadStatistics().epaQueries;
+        if (m_EPAMode == EPAMode::Heap) return HeapEPA(simplex, colliderA, frameA, colliderB, frameB, hints);
+
+        Buffer<Support, s_MaxEPAVertices> polytope;
+        Buffer<Face, s_MaxEPAFaces> faces;
+        EdgeBuffer uniqueEdges;
 
         polytope.push_back(simplex.A);
         polytope.push_back(simplex.B);
         polytope.push_back(simplex.C);
         polytope.push_back(simplex.D);
-        faces.push_back(Face(0, 1, 2, polytope));   // Add face ABC to the polytope.
-        faces.push_back(Face(0, 3, 1, polytope));   // Add face ADB to the polytope.
-        faces.push_back(Face(0, 2, 3, polytope));   // Add face ACD to the polytope.
-        faces.push_back(Face(1, 3, 2, polytope));   // Add face BDC to the polytope.
+        faces.push_back(Face(0, 1, 2, polytope.begin()));   // Add face ABC to the polytope.
+        faces.push_back(Face(0, 3, 1, polytope.begin()));   // Add face ADB to the polytope.
+        faces.push_back(Face(0, 2, 3, polytope.begin()));   // Add face ACD to the polytope.
+        faces.push_back(Face(1, 3, 2, polytope.begin()));   // Add face BDC to the polytope.
 
         Support support;
         Vector3 direction;
@@ -208,6 +440,8 @@ namespace Engine
 
         for (size_t iteration = 0; iteration < s_MaxEPAIterations; ++iteration)
         {
+            ++GetThreadStatistics().epaIterations;
+
             // Find closest face to the origin.
             closestFace = 0;
             minDistance = faces[0].distance;
@@ -222,34 +456,9 @@ namespace Engine
 
             // Search towards the normal of the face that's closest to origin.
             direction = faces[closestFace].normal;
-            support = GetSupport(colliderA, transformA, colliderB, transformB, direction);
+            support = GetSupport(colliderA, frameA, colliderB, frameB, direction, hints);
 
-            if (Dot(support.point, direction) - minDistance < 1e-3f)
-            {
-                CollisionInfo info;
-                info.status = CollisionInfo::Status::Colliding;
-                info.depth = minDistance;
-                info.normal = faces[closestFace].normal;
-                
-                // Project origin onto the closest face plane
-                Vector3 originProjection = minDistance * faces[closestFace].normal;
-                
-                Vector3 barycentricCoordinates = ConvertToBarycentric(originProjection,
-                                                    polytope[faces[closestFace].a].point,
-                                                    polytope[faces[closestFace].b].point,
-                                                    polytope[faces[closestFace].c].point
-                                                );
-                
-                info.contactPointA = polytope[faces[closestFace].a].pointFromA * barycentricCoordinates.x +
-                                     polytope[faces[closestFace].b].pointFromA * barycentricCoordinates.y +
-                                     polytope[faces[closestFace].c].pointFromA * barycentricCoordinates.z;
-                
-                info.contactPointB = polytope[faces[closestFace].a].pointFromB * barycentricCoordinates.x +
-                                     polytope[faces[closestFace].b].pointFromB * barycentricCoordinates.y +
-                                     polytope[faces[closestFace].c].pointFromB * barycentricCoordinates.z;
-                
-                return info;
-            }
+            if (Dot(support.point, direction) - minDistance < 1e-3f) return GetEPAContact(faces[closestFace], polytope.begin());
 
             uniqueEdges.clear();
             for (size_t index = 0; index < faces.size();)
@@ -268,176 +477,1843 @@ namespace Engine
                 else ++index;
             }
 
+            // A degenerate polytope can fold over itself, give up rather than overflow the buffers.
+            if (polytope.IsFull() || faces.size() + uniqueEdges.size() > s_MaxEPAFaces) break;
+
             // We can now add the new support point into the polytope.
             polytope.push_back(support);
-            for (auto [a, b] : uniqueEdges) faces.push_back(Face(a, b, polytope.size() - 1, polytope));
+            for (auto [a, b] : uniqueEdges) faces.push_back(Face(a, b, polytope.size() - 1, polytope.begin()));
+        }
+
+        CollisionInfo info;
+        info.status = CollisionInfo::Status::EPAFailed;
+        return info;
+    }
+    Solver::CollisionInfo Solver::HeapEPA(const Simplex& simplex, const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB, SupportHints& hints)
+    {
+        Buffer<Support, s_MaxEPAVertices> polytope;
+        Buffer<Face, s_MaxHeapEPAFaces> faces;
+        Buffer<HeapEntry, s_MaxHeapEPAFaces> heap;
+        Buffer<uint32_t, s_MaxHeapEPAFaces> stack;
+        EdgeBuffer horizon;
+        EdgeMap edges;
+
+        auto closer = [](const HeapEntry& a, const HeapEntry& b) { return a.distance > b.distance; };
+        auto addFace = [&](size_t a, size_t b, size_t c)
+        {
+            uint32_t face = static_cast<uint32_t>(faces.size());
+            faces.push_back(Face(a, b, c, polytope.begin()));
+            edges.Insert(a, b, face);
+            edges.Insert(b, c, face);
+            edges.Insert(c, a, face);
+            heap.push_back({ faces.back().distance, face });
+            std::push_heap(heap.begin(), heap.end(), closer);
+        };
+
+        polytope.push_back(simplex.A);
+        polytope.push_back(simplex.B);
+        polytope.push_back(simplex.C);
+        polytope.push_back(simplex.D);
+        addFace(0, 1, 2);
+        addFace(0, 3, 1);
+        addFace(0, 2, 3);
+        addFace(1, 3, 2);
+
+        for (size_t iteration = 0; iteration < s_MaxEPAIterations; ++iteration)
+        {
+            ++GetThreadStatistics().epaIterations;
+
+            // Faces removed since they were pushed are dropped when they reach the top.
+            while (heap.size() > 0 && faces[heap[0].face].removed)
+            {
+                std::pop_heap(heap.begin(), heap.end(), closer);
+                heap.pop_back();
+            }
+            if (heap.size() == 0) break;
+
+            uint32_t closest = heap[0].face;
+            Support support = GetSupport(colliderA, frameA, colliderB, frameB, faces[closest].normal, hints);
+            if (Dot(support.point, faces[closest].normal) - faces[closest].distance < 1e-3f) return GetEPAContact(faces[closest], polytope.begin());
+
+            // The closest face sees the new point, flood out through its neighbours to the rest of the visible faces.
+            // Edges leading to a face that can't see the point form the horizon.
+            horizon.clear();
+            stack.clear();
+            faces[closest].removed = true;
+            stack.push_back(closest);
+            while (stack.size() > 0)
+            {
+                Face face = faces[stack.back()];
+                stack.pop_back();
+                for (auto [a, b] : { Edge{ face.a, face.b }, Edge{ face.b, face.c }, Edge{ face.c, face.a } })
+                {
+                    uint32_t neighbour = edges.Find(b, a);
+                    if (neighbour != s_NullFace && faces[neighbour].removed) continue;
+                    if (neighbour != s_NullFace && SameDirection(faces[neighbour].normal, support.point - polytope[faces[neighbour].a].point))
+                    {
+                        faces[neighbour].removed = true;
+                        stack.push_back(neighbour);
+                    }
+                    else if (!horizon.IsFull()) horizon.push_back({ a, b });
+                }
+            }
+
+            // A degenerate polytope can fold over itself, give up rather than overflow the buffers.
+            if (polytope.IsFull() || horizon.IsFull() || faces.size() + horizon.size() > s_MaxHeapEPAFaces) break;
+
+            polytope.push_back(support);
+            for (auto [a, b] : horizon) addFace(a, b, polytope.size() - 1);
         }
 
         CollisionInfo info;
         info.status = CollisionInfo::Status::EPAFailed;
         return info;
     }
-    void Solver::AddUniqueEdge(std::vector<std::pair<size_t, size_t>>& edges, size_t a, size_t b)
+    void Solver::EdgeMap::Insert(size_t a, size_t b, uint32_t face)
+    {
+        // A horizon edge gets a new face on the same side, overwrite the removed owner rather than add a second slot.
+        uint32_t key = static_cast<uint32_t>(a << 16 | b);
+        size_t index = (key * 2654435769u) >> 20 & (s_EdgeMapCapacity - 1);
+        while (occupied[index] && slots[index].key != key) index = (index + 1) & (s_EdgeMapCapacity - 1);
+        occupied[index] = true;
+        slots[index] = { key, face };
+    }
+    uint32_t Solver::EdgeMap::Find(size_t a, size_t b) const
     {
-        auto reverse = std::find(edges.begin(), edges.end(), std::make_pair(b, a));
-        if (reverse != edges.end()) edges.erase(reverse);
-        else edges.emplace_back(a, b);
+        uint32_t key = static_cast<uint32_t>(a << 16 | b);
+        for (size_t index = (key * 2654435769u) >> 20 & (s_EdgeMapCapacity - 1); occupied[index]; index = (index + 1) & (s_EdgeMapCapacity - 1))
+        {
+            if (slots[index].key == key) return slots[index].face;
+        }
+        return s_NullFace;
     }
+    Solver::CollisionInfo Solver::GetEPAContact(const Face& face, const Support* polytope)
+    {
+        CollisionInfo info;
+        info.status = CollisionInfo::Status::Colliding;
+        info.depth = face.distance;
+        info.normal = face.normal;
+
+        // Project origin onto the closest face plane
+        Vector3 originProjection = face.distance * face.normal;
+        Vector3 barycentricCoordinates = ConvertToBarycentric(originProjection, polytope[face.a].point, polytope[face.b].point, polytope[face.c].point);
 
-    void Solver::ResolveCollision(Physics& physicsA, Transform& transformA, Physics& physicsB, Transform& transformB, const CollisionInfo& collision)
+        Vector3 contactPointA = polytope[face.a].pointFromA * barycentricCoordinates.x +
+                                polytope[face.b].pointFromA * barycentricCoordinates.y +
+                                polytope[face.c].pointFromA * barycentricCoordinates.z;
+
+        Vector3 contactPointB = polytope[face.a].pointFromB * barycentricCoordinates.x +
+                                polytope[face.b].pointFromB * barycentricCoordinates.y +
+                                polytope[face.c].pointFromB * barycentricCoordinates.z;
+
+        info.AddContact(contactPointA, contactPointB);
+        return info;
+    }
+    void Solver::AddUniqueEdge(EdgeBuffer& edges, size_t a, size_t b)
     {
-        // Calculate relative positions from center of mass to contact point.
-        Vector3 relativeA = collision.contactPointA - transformA.GetPosition();
-        Vector3 relativeB = collision.contactPointB - transformB.GetPosition();
-        
-        // Calculate velocity at contact point (linear + angular contribution).
-        Vector3 angularVelocityA = Cross(physicsA.GetAngularVelocity(), relativeA);
-        Vector3 angularVelocityB = Cross(physicsB.GetAngularVelocity(), relativeB);
-        
-        Vector3 fullVelocityA = physicsA.GetVelocity() + angularVelocityA;
-        Vector3 fullVelocityB = physicsB.GetVelocity() + angularVelocityB;
-        
-        Vector3 relativeVelocity = fullVelocityB - fullVelocityA;
-        float velocityAlongNormal = Dot(relativeVelocity, collision.normal);
-        
-        // Calculate angular effect on impulse (only for non-stationary objects).
-        Vector3 inertiaA = Vector3(0.0f);
-        Vector3 inertiaB = Vector3(0.0f);
-        Matrix3 inverseInertiaTensorWorldA = Matrix3(0.0f);
-        Matrix3 inverseInertiaTensorWorldB = Matrix3(0.0f);
-        
-        // TODO: This is wrong and bad (incorrect inertia scaling calculations).
-        if (!physicsA.IsStationary())
+        auto reverse = std::find_if(edges.begin(), edges.end(), [a, b](const Edge& edge) { return edge.a == b && edge.b == a; });
+        if (reverse == edges.end()) edges.push_back({ a, b });
+        else
+        {
+            // Edge order doesn't matter, fill the gap with the last one.
+            *reverse = edges.back();
+            edges.pop_back();
+        }
+    }
+
+    float Solver::GetDistance(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB, Vector3& normal, SupportHints& hints)
+    {
+        // GJK on the closest point of the Minkowski difference instead of on containing the origin, zero when the shapes overlap.
+        Buffer<Vector3, 4> simplex;
+        Vector3 closest = GetSupport(colliderA, frameA, colliderB, frameB, frameB.position - frameA.position + Vector3(1e-6f), hints).point;
+        simplex.push_back(closest);
+        for (size_t iteration = 0; iteration < s_MaxGJKIterations; ++iteration)
         {
-            Matrix3 rotationMatrixA = Matrix3(transformA.GetRotationMatrix());
-            Matrix3 inverseScalingMatrixA = Matrix3(transformA.GetInverseScalingMatrix());
-            inverseInertiaTensorWorldA = rotationMatrixA * inverseScalingMatrixA * physicsA.GetInverseInertiaTensor() * inverseScalingMatrixA * Transposed(rotationMatrixA);
-            inertiaA = Cross(inverseInertiaTensorWorldA * Cross(relativeA, collision.normal), relativeA);
+            float distanceSquared = LengthSquared(closest);
+            if (distanceSquared < 1e-12f) return 0.0f;
+
+            // Nothing in the difference lies much further towards the origin than the current point, it's the closest one.
+            Vector3 point = GetSupport(colliderA, frameA, colliderB, frameB, -closest, hints).point;
+            if (distanceSquared - Dot(closest, point) <= s_DistanceTolerance * SquareRoot(distanceSquared)) break;
+
+            simplex.push_back(point);
+            Vector3 next = ClosestOnSimplex(simplex);
+            if (simplex.size() == 4) return 0.0f;
+
+            // Rounding stops the point from getting any closer long before the iteration limit.
+            if (LengthSquared(next) >= distanceSquared) break;
+            closest = next;
         }
-        if (!physicsB.IsStationary())
+        float distance = Length(closest);
+        if (distance < 1e-6f) return 0.0f;
+        normal = -closest / distance;
+        return distance;
+    }
+    Vector3 Solver::ClosestOnSimplex(Buffer<Vector3, 4>& simplex)
+    {
+        // Shrinks the simplex to the points the closest one is a combination of, the newest point comes last.
+        if (simplex.size() == 2)
         {
-            Matrix3 rotationMatrixB = Matrix3(transformB.GetRotationMatrix());
-            Matrix3 inverseScalingMatrixB = Matrix3(transformB.GetInverseScalingMatrix());
-            inverseInertiaTensorWorldB = rotationMatrixB * inverseScalingMatrixB * physicsB.GetInverseInertiaTensor() * inverseScalingMatrixB * Transposed(rotationMatrixB);
-            inertiaB = Cross(inverseInertiaTensorWorldB * Cross(relativeB, collision.normal), relativeB);
+            Vector3 a = simplex[0];
+            Vector3 ab = simplex[1] - a;
+            float t = Clamp(-Dot(a, ab) / Max(LengthSquared(ab), 1e-12f), 0.0f, 1.0f);
+            if (t == 0.0f || t == 1.0f)
+            {
+                simplex[0] = t == 0.0f ? simplex[0] : simplex[1];
+                simplex.count = 1;
+            }
+            return a + ab * t;
         }
-        float angularEffect = Dot(inertiaA + inertiaB, collision.normal);
-        
-        // Calculate normal impulse magnitude.
-        float e = Min(physicsA.GetRestitution(), physicsB.GetRestitution());
-        float j = -(1.0f + e) * velocityAlongNormal;
-        j /= (physicsA.GetInverseMass() + physicsB.GetInverseMass() + angularEffect);
-        
-        Vector3 impulse = j * collision.normal;
-        
-        // Apply linear impulses.
-        if (!physicsA.IsStationary()) physicsA.ApplyLinearImpulse(-impulse);
-        if (!physicsB.IsStationary()) physicsB.ApplyLinearImpulse(impulse);
-        
-        // Apply angular impulses.
-        if (!physicsA.IsStationary()) physicsA.ApplyAngularImpulse(Cross(relativeA, -impulse), inverseInertiaTensorWorldA);
-        if (!physicsB.IsStationary()) physicsB.ApplyAngularImpulse(Cross(relativeB, impulse), inverseInertiaTensorWorldB);
-        
-        // Calculate and apply friction impulses.
-        Vector3 tangent = relativeVelocity - velocityAlongNormal * collision.normal;
-        float tangentLength = Length(tangent);
-        
-        if (tangentLength > 0.0001f) // Avoid division by zero
+        if (simplex.size() == 3) return ClosestOnTriangle(simplex[0], simplex[1], simplex[2], simplex);
+
+        // A tetrahedron holds the origin unless it lies past one of the faces, then the closest point is on those faces.
+        Vector3 points[4] = { simplex[0], simplex[1], simplex[2], simplex[3] };
+        constexpr size_t faces[4][4] = { { 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 } };
+        bool degenerate = Abs(Dot(points[3] - points[0], Cross(points[1] - points[0], points[2] - points[0]))) < 1e-9f;
+        Vector3 closest = Vector3(0.0f);
+        float closestSquared = std::numeric_limits<float>::infinity();
+        for (const auto& face : faces)
+        {
+            const Vector3& a = points[face[0]];
+            Vector3 normal = Cross(points[face[1]] - a, points[face[2]] - a);
+            if (!degenerate && Dot(-a, normal) * Dot(points[face[3]] - a, normal) >= 0.0f) continue;
+
+            Buffer<Vector3, 4> reduced;
+            Vector3 point = ClosestOnTriangle(a, points[face[1]], points[face[2]], reduced);
+            if (LengthSquared(point) >= closestSquared) continue;
+            closest = point;
+            closestSquared = LengthSquared(point);
+            simplex = reduced;
+        }
+        return closest;
+    }
+    Vector3 Solver::ClosestOnTriangle(const Vector3& a, const Vector3& b, const Vector3& c, Buffer<Vector3, 4>& simplex)
+    {
+        // Voronoi regions of the triangle in turn, as in Ericson's Real-Time Collision Detection.
+        auto keep = [&simplex](std::initializer_list<Vector3> points)
+        {
+            simplex.clear();
+            for (const Vector3& point : points) simplex.push_back(point);
+        };
+        Vector3 ab = b - a;
+        Vector3 ac = c - a;
+        float d1 = -Dot(ab, a);
+        float d2 = -Dot(ac, a);
+        if (d1 <= 0.0f && d2 <= 0.0f)
+        {
+            keep({ a });
+            return a;
+        }
+        float d3 = -Dot(ab, b);
+        float d4 = -Dot(ac, b);
+        if (d3 >= 0.0f && d4 <= d3)
+        {
+            keep({ b });
+            return b;
+        }
+        float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        {
+            keep({ a, b });
+            return a + ab * (d1 / Max(d1 - d3, 1e-12f));
+        }
+        float d5 = -Dot(ab, c);
+        float d6 = -Dot(ac, c);
+        if (d6 >= 0.0f && d5 <= d6)
+        {
+            keep({ c });
+            return c;
+        }
+        float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
         {
-            tangent /= tangentLength; // Normalize tangent
-            
-            // Calculate angular effect for tangent direction.
-            Vector3 inertiaTangentA = Vector3(0.0f);
-            Vector3 inertiaTangentB = Vector3(0.0f);
-            
-            if (!physicsA.IsStationary())
+            keep({ a, c });
+            return a + ac * (d2 / Max(d2 - d6, 1e-12f));
+        }
+        float va = d3 * d6 - d5 * d4;
+        if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+        {
+            keep({ b, c });
+            return b + (c - b) * ((d4 - d3) / Max((d4 - d3) + (d5 - d6), 1e-12f));
+        }
+        keep({ a, b, c });
+        float denominator = 1.0f / Max(va + vb + vc, 1e-12f);
+        return a + ab * (vb * denominator) + ac * (vc * denominator);
+    }
+
+    const Solver::CollisionTable Solver::s_CollisionTable = []()
+    {
+        CollisionTable table;
+        for (auto& row : table) row.fill(&Solver::GJK);
+
+        auto set = [&table](Collider::Shape shapeA, Collider::Shape shapeB, CollisionTest test) { table[static_cast<size_t>(shapeA)][static_cast<size_t>(shapeB)] = test; };
+        set(Collider::Shape::Sphere, Collider::Shape::Sphere, &Solver::SphereSphere);
+        set(Collider::Shape::Sphere, Collider::Shape::Plane, &Solver::SpherePlane);
+        set(Collider::Shape::Plane, Collider::Shape::Sphere, &Solver::Flipped<&Solver::SpherePlane>);
+        set(Collider::Shape::Sphere, Collider::Shape::Cube, &Solver::SphereBox);
+        set(Collider::Shape::Cube, Collider::Shape::Sphere, &Solver::Flipped<&Solver::SphereBox>);
+        set(Collider::Shape::Cube, Collider::Shape::Plane, &Solver::BoxPlane);
+        set(Collider::Shape::Plane, Collider::Shape::Cube, &Solver::Flipped<&Solver::BoxPlane>);
+        set(Collider::Shape::Cube, Collider::Shape::Cube, &Solver::BoxBox);
+        set(Collider::Shape::Capsule, Collider::Shape::Sphere, &Solver::CapsuleSphere);
+        set(Collider::Shape::Sphere, Collider::Shape::Capsule, &Solver::Flipped<&Solver::CapsuleSphere>);
+        set(Collider::Shape::Capsule, Collider::Shape::Capsule, &Solver::CapsuleCapsule);
+        set(Collider::Shape::Capsule, Collider::Shape::Plane, &Solver::CapsulePlane);
+        set(Collider::Shape::Plane, Collider::Shape::Capsule, &Solver::Flipped<&Solver::CapsulePlane>);
+        for (Collider::Shape shape : { Collider::Shape::Cube, Collider::Shape::Plane, Collider::Shape::Sphere, Collider::Shape::Capsule, Collider::Shape::Triangle, Collider::Shape::Mesh })
+        {
+            set(shape, Collider::Shape::TriangleMesh, &Solver::ConvexTriangles<TriangleMeshCollider>);
+            set(Collider::Shape::TriangleMesh, shape, &Solver::Flipped<&Solver::ConvexTriangles<TriangleMeshCollider>>);
+            set(shape, Collider::Shape::Heightfield, &Solver::ConvexTriangles<HeightfieldCollider>);
+            set(Collider::Shape::Heightfield, shape, &Solver::Flipped<&Solver::ConvexTriangles<HeightfieldCollider>>);
+        }
+        return table;
+    }();
+
+    Solver::PairCache& Solver::GetPairCache(uint64_t key, bool& cached)
+    {
+        auto hash = [key](const std::vector<PairCache>& table) { return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & (table.size() - 1); };
+
+        size_t index = hash(m_PairCache);
+        while (m_PairCache[index].stamp == m_Stamp && m_PairCache[index].key != key) index = (index + 1) & (m_PairCache.size() - 1);
+        PairCache& cache = m_PairCache[index];
+        if (cache.stamp == m_Stamp)
+        {
+            cached = true;
+            return cache;
+        }
+
+        cached = false;
+        cache = { key, m_Stamp, Vector3(0.0f), Manifold(), SupportHints() };
+        if (m_PreviousPairCache.empty()) return cache;
+        for (index = hash(m_PreviousPairCache); m_PreviousPairCache[index].stamp == m_Stamp - 1; index = (index + 1) & (m_PreviousPairCache.size() - 1))
+        {
+            if (m_PreviousPairCache[index].key != key) continue;
+            cache = m_PreviousPairCache[index];
+            cache.stamp = m_Stamp;
+            cached = true;
+            break;
+        }
+        return cache;
+    }
+    Solver::CollisionTest Solver::GetCollisionTest(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB)
+    {
+        Collider::Shape shapeA = colliderA.GetShape();
+        Collider::Shape shapeB = colliderB.GetShape();
+
+        // Non uniformly scaled spheres and capsules are no longer round, leave those to GJK.
+        auto isRound = [](Collider::Shape shape) { return shape == Collider::Shape::Sphere || shape == Collider::Shape::Capsule; };
+        if ((isRound(shapeA) && !IsUniform(frameA.scale)) || (isRound(shapeB) && !IsUniform(frameB.scale))) return &Solver::GJK;
+        return s_CollisionTable[static_cast<size_t>(shapeA)][static_cast<size_t>(shapeB)];
+    }
+    Solver::CollisionInfo Solver::Collide(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB, Vector3& direction, SupportHints& hints, bool cached)
+    {
+        CollisionTest test = GetCollisionTest(colliderA, frameA, colliderB, frameB);
+        if (test != static_cast<CollisionTest>(&Solver::GJK)) return (this->*test)(colliderA, frameA, colliderB, frameB);
+
+        // Pairs without a closed form test start GJK from where it ended last step, resting pairs usually separate on the first support.
+        if (cached) ++GetThreadStatistics().gjkCacheHits;
+        else direction = frameA.position - frameB.position + Vector3(1e-6f);
+        CollisionInfo info = GJK(colliderA, frameA, colliderB, frameB, direction, hints);
+        if (LengthSquared(direction) < 1e-12f) direction = frameA.position - frameB.position + Vector3(1e-6f);
+        return info;
+    }
+
+    bool Solver::IsUniform(const Vector3& scale) { return Abs(scale.x - scale.y) < 1e-6f && Abs(scale.y - scale.z) < 1e-6f; }
+    Solver::Box Solver::GetBox(const Frame& frame, const Vector3& halfExtents)
+    {
+        Box box;
+        box.center = frame.position;
+        box.axes[0] = frame.rotation[0];
+        box.axes[1] = frame.rotation[1];
+        box.axes[2] = frame.rotation[2];
+        box.halfExtents = Hadamard(halfExtents, frame.scale);
+        return box;
+    }
+    Solver::Capsule Solver::GetCapsule(const Frame& frame, const CapsuleCollider& collider)
+    {
+        Capsule capsule;
+        capsule.center = frame.position;
+        capsule.axis = frame.rotation[2];
+        capsule.halfLength = collider.GetHalfLength() * frame.scale.x;
+        capsule.radius = collider.GetRadius() * frame.scale.x;
+        return capsule;
+    }
+    Bounds Solver::GetLocalBounds(const Bounds& bounds, const Frame& frame)
+    {
+        // The box around the corners taken to the frame's space.
+        Bounds local;
+        for (size_t corner = 0; corner < 8; ++corner)
+        {
+            Vector3 point = frame.ToLocalPoint(Vector3((corner & 1) ? bounds.max.x : bounds.min.x, (corner & 2) ? bounds.max.y : bounds.min.y, (corner & 4) ? bounds.max.z : bounds.min.z));
+            local = corner ? Merged(local, Bounds(point, point)) : Bounds(point, point);
+        }
+        return local;
+    }
+
+    Solver::CollisionInfo Solver::SphereSphere(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB)
+    {
+        float radiusA = colliderA.Get<SphereCollider>().GetRadius() * frameA.scale.x;
+        float radiusB = colliderB.Get<SphereCollider>().GetRadius() * frameB.scale.x;
+        return TestSphereSphere(frameA.position, radiusA, frameB.position, radiusB);
+    }
+    Solver::CollisionInfo Solver::SpherePlane(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB)
+    {
+        // A plane is a box without thickness.
+        float radius = colliderA.Get<SphereCollider>().GetRadius() * frameA.scale.x;
+        float halfLength = colliderB.Get<PlaneCollider>().GetHalfLength();
+        return TestSphereBox(frameA.position, radius, GetBox(frameB, Vector3(halfLength, halfLength, 0.0f)));
+    }
+    Solver::CollisionInfo Solver::SphereBox(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB)
+    {
+        float radius = colliderA.Get<SphereCollider>().GetRadius() * frameA.scale.x;
+        float halfLength = colliderB.Get<CubeCollider>().GetHalfLength();
+        return TestSphereBox(frameA.position, radius, GetBox(frameB, Vector3(halfLength)));
+    }
+    Solver::CollisionInfo Solver::BoxPlane(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB)
+    {
+        float halfLengthA = colliderA.Get<CubeCollider>().GetHalfLength();
+        float halfLengthB = colliderB.Get<PlaneCollider>().GetHalfLength();
+        return TestBoxBox(GetBox(frameA, Vector3(halfLengthA)), GetBox(frameB, Vector3(halfLengthB, halfLengthB, 0.0f)));
+    }
+    Solver::CollisionInfo Solver::BoxBox(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB)
+    {
+        float halfLengthA = colliderA.Get<CubeCollider>().GetHalfLength();
+        float halfLengthB = colliderB.Get<CubeCollider>().GetHalfLength();
+        return TestBoxBox(GetBox(frameA, Vector3(halfLengthA)), GetBox(frameB, Vector3(halfLengthB)));
+    }
+    Solver::CollisionInfo Solver::CapsuleSphere(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB)
+    {
+        // The sphere touches the capsule where it touches the sphere around the closest point of the segment.
+        Capsule capsule = GetCapsule(frameA, colliderA.Get<CapsuleCollider>());
+        float radius = colliderB.Get<SphereCollider>().GetRadius() * frameB.scale.x;
+        float t = Clamp(Dot(frameB.position - capsule.center, capsule.axis), -capsule.halfLength, capsule.halfLength);
+        return TestSphereSphere(capsule.center + capsule.axis * t, capsule.radius, frameB.position, radius);
+    }
+    Solver::CollisionInfo Solver::CapsuleCapsule(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB)
+    {
+        Capsule capsuleA = GetCapsule(frameA, colliderA.Get<CapsuleCollider>());
+        Capsule capsuleB = GetCapsule(frameB, colliderB.Get<CapsuleCollider>());
+        auto test = [&](float s, float t) { return TestSphereSphere(capsuleA.center + capsuleA.axis * s, capsuleA.radius, capsuleB.center + capsuleB.axis * t, capsuleB.radius); };
+
+        float b = Dot(capsuleA.axis, capsuleB.axis);
+        if (1.0f - b * b <= 1e-4f)
+        {
+            // Parallel segments touch along the stretch where they overlap, both ends of it keep the pair from rocking.
+            float c = Dot(capsuleA.axis, capsuleA.center - capsuleB.center);
+            float f = Dot(capsuleB.axis, capsuleA.center - capsuleB.center);
+            float low = Max(-c - capsuleB.halfLength, -capsuleA.halfLength);
+            float high = Min(-c + capsuleB.halfLength, capsuleA.halfLength);
+            auto project = [&](float s) { return Clamp(b * s + f, -capsuleB.halfLength, capsuleB.halfLength); };
+            if (high - low > 1e-3f) return Combined(test(low, project(low)), test(high, project(high)));
+        }
+
+        float s;
+        float t;
+        ClosestPoints(capsuleA, capsuleB, s, t);
+        return test(s, t);
+    }
+    Solver::CollisionInfo Solver::CapsulePlane(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB)
+    {
+        Capsule capsule = GetCapsule(frameA, colliderA.Get<CapsuleCollider>());
+        float halfLength = colliderB.Get<PlaneCollider>().GetHalfLength();
+        Box plane = GetBox(frameB, Vector3(halfLength, halfLength, 0.0f));
+
+        // Height over the plane is linear along the segment, so the deepest points are the ends of the part above the plane's area.
+        float low = -capsule.halfLength;
+        float high = capsule.halfLength;
+        Vector3 offset = capsule.center - plane.center;
+        for (size_t axis = 0; axis < 2; ++axis)
+        {
+            float start = Dot(offset, plane.axes[axis]);
+            float rate = Dot(capsule.axis, plane.axes[axis]);
+            if (Abs(rate) < 1e-6f)
+            {
+                if (Abs(start) > plane.halfExtents[axis]) low = high + 1.0f;
+                continue;
+            }
+            float first = (-plane.halfExtents[axis] - start) / rate;
+            float second = (plane.halfExtents[axis] - start) / rate;
+            low = Max(low, Min(first, second));
+            high = Min(high, Max(first, second));
+        }
+        if (low <= high)
+        {
+            // A segment through the plane leaves on the side holding more of it, the other end is pulled back across.
+            float heightLow = Dot(offset, plane.axes[2]) + Dot(capsule.axis, plane.axes[2]) * low;
+            float heightHigh = Dot(offset, plane.axes[2]) + Dot(capsule.axis, plane.axes[2]) * high;
+            Vector3 side = plane.axes[2] * (((Abs(heightHigh) >= Abs(heightLow)) ? heightHigh : heightLow) >= 0.0f ? 1.0f : -1.0f);
+            auto test = [&](float t, float height)
+            {
+                CollisionInfo info;
+                float depth = capsule.radius - Dot(side, plane.axes[2]) * height;
+                if (depth < 0.0f)
+                {
+                    info.status = CollisionInfo::Status::Separated;
+                    return info;
+                }
+
+                Vector3 point = capsule.center + capsule.axis * t;
+                info.status = CollisionInfo::Status::Colliding;
+                info.normal = -side;
+                info.depth = depth;
+                info.AddContact(point - side * capsule.radius, point - plane.axes[2] * height);
+                return info;
+            };
+            CollisionInfo info = test(low, heightLow);
+            if (high - low > 1e-3f) info = Combined(info, test(high, heightHigh));
+            if (info) return info;
+        }
+
+        // Nothing over the plane's area touches it, what is left is the rim, take the closest of the four edges.
+        CollisionInfo info;
+        info.status = CollisionInfo::Status::Separated;
+        float closestSquared = Square(capsule.radius);
+        for (size_t axis = 0; axis < 2; ++axis)
+        {
+            for (float sign : { 1.0f, -1.0f })
             {
-                inertiaTangentA = Cross(inverseInertiaTensorWorldA * Cross(relativeA, tangent), relativeA);
+                Capsule edge = { plane.center + plane.axes[axis] * plane.halfExtents[axis] * sign, plane.axes[1 - axis], plane.halfExtents[1 - axis], 0.0f };
+                float s;
+                float t;
+                ClosestPoints(capsule, edge, s, t);
+                Vector3 point = capsule.center + capsule.axis * s;
+                Vector3 rim = edge.center + edge.axis * t;
+                if (LengthSquared(rim - point) > closestSquared) continue;
+                closestSquared = LengthSquared(rim - point);
+                info = TestSphereSphere(point, capsule.radius, rim, 0.0f);
             }
-            if (!physicsB.IsStationary())
+        }
+        return info;
+    }
+
+    template <typename T>
+    Solver::CollisionInfo Solver::ConvexTriangles(const ColliderVariant& colliderA, const Frame& frameA, const ColliderVariant& colliderB, const Frame& frameB)
+    {
+        // Triangle meshes and heightfields hand over their triangles in the same packets.
+        const T& mesh = colliderB.Get<T>();
+        Statistics& statistics = GetThreadStatistics();
+        Bounds bounds = colliderA.GetWorldBounds(frameA);
+
+        // Triangles further from the center of the body's bounds than their corners can't touch it, for spheres the test is exact.
+        // Rounded boxes are also held against each triangle's plane, the first separating axis.
+        bool sphere = colliderA.GetShape() == Collider::Shape::Sphere && IsUniform(frameA.scale);
+        bool rounded = !sphere && IsRoundedBox(colliderA);
+        float radius = sphere ? colliderA.Get<SphereCollider>().GetRadius() * frameA.scale.x : Length(bounds.GetExtents());
+        Vector3 center = sphere ? frameA.position : bounds.GetCenter();
+        RoundedBoxes body;
+        if (rounded) for (size_t lane = 0; lane < LaneCount; ++lane) SetRoundedBox(body, lane, colliderA, frameA);
+        Vector3Lanes centers = { FloatLanes(center.x), FloatLanes(center.y), FloatLanes(center.z) };
+        Vector3Lanes origin = { FloatLanes(frameB.position.x), FloatLanes(frameB.position.y), FloatLanes(frameB.position.z) };
+        Vector3Lanes columns[3];
+        for (size_t column = 0; column < 3; ++column) columns[column] = { FloatLanes(frameB.linear[column].x), FloatLanes(frameB.linear[column].y), FloatLanes(frameB.linear[column].z) };
+
+        std::array<Contact, s_MaxMeshContacts> contacts;
+        std::array<Vector3, s_MaxMeshContacts> normals;
+        std::array<float, s_MaxMeshContacts> depths;
+        size_t contactCount = 0;
+        SupportHints hints;     // A hull body climbs from where the last triangle left it.
+        auto add = [&](const Vector3& pointA, const Vector3& pointB, const Vector3& normal, float depth)
+        {
+            // Neighbouring triangles find the same point on their shared edge, only one is kept. Past the limit the shallowest makes room.
+            size_t slot = contactCount;
+            for (size_t index = 0; index < contactCount; ++index) if (LengthSquared(contacts[index].pointB - pointB) < Square(s_LinearSlop)) slot = index;
+            if (slot == s_MaxMeshContacts) slot = static_cast<size_t>(std::min_element(depths.begin(), depths.end()) - depths.begin());
+            if (slot < contactCount && depths[slot] >= depth) return;
+            contacts[slot] = { pointA, pointB };
+            normals[slot] = normal;
+            depths[slot] = depth;
+            if (slot == contactCount) ++contactCount;
+        };
+
+        mesh.Query(GetLocalBounds(bounds, frameB), [&](const TriangleMeshCollider::TrianglePacket& packet, uint32_t count)
+        {
+            statistics.meshTriangles += count;
+            Vector3Lanes vertices[3];
+            for (size_t vertex = 0; vertex < 3; ++vertex)
             {
-                inertiaTangentB = Cross(inverseInertiaTensorWorldB * Cross(relativeB, tangent), relativeB);
+                const auto& local = packet.vertices[vertex];
+                vertices[vertex] = columns[0] * Load(local[0]) + columns[1] * Load(local[1]) + columns[2] * Load(local[2]) + origin;
             }
-            float angularEffectTangent = Dot(inertiaTangentA + inertiaTangentB, tangent);
-            
-            // Calculate friction impulse magnitude.
-            float jt = -Dot(relativeVelocity, tangent);
-            jt /= (physicsA.GetInverseMass() + physicsB.GetInverseMass() + angularEffectTangent);
-            
-            // Apply Coulomb friction (static vs dynamic).
-            float mu = (physicsA.GetFriction() + physicsB.GetFriction()) * 0.5f;
-            Vector3 frictionImpulse;
-            
-            if (Abs(jt) < j * mu)
+            Vector3Lanes closest = GetClosestPoint(centers, vertices[0], vertices[1], vertices[2]);
+            Vector3Lanes normal = Cross(vertices[1] - vertices[0], vertices[2] - vertices[0]);
+            MaskLanes touching = LengthSquared(closest - centers) <= FloatLanes(radius * radius);
+            if (rounded)
             {
-                // Static friction
-                frictionImpulse = jt * tangent;
+                FloatLanes plane = Dot(normal, vertices[0]);
+                touching = touching & (Dot(GetSupport(body, -normal), normal) <= plane) & (Dot(GetSupport(body, normal), normal) >= plane);
             }
-            else
+            uint32_t lanes = ToBits(touching) & ((1u << count) - 1);
+            if (lanes == 0) return;
+
+            std::array<Vector3, LaneCount> closestPoints;
+            std::array<Vector3, LaneCount> faceNormals;
+            StoreInterleaved(closestPoints[0].data, closest.x, closest.y, closest.z);
+            StoreInterleaved(faceNormals[0].data, normal.x, normal.y, normal.z);
+            for (size_t lane = 0; lane < count; ++lane)
             {
-                // Dynamic friction
-                frictionImpulse = -j * mu * tangent;
+                if (!(lanes >> lane & 1)) continue;
+                ++statistics.meshTriangleTests;
+                if (sphere)
+                {
+                    // A center right on the triangle leaves by the front face.
+                    Vector3 offset = closestPoints[lane] - center;
+                    float distance = Length(offset);
+                    Vector3 direction = (distance > 1e-6f) ? offset / distance : -Normalized(faceNormals[lane]);
+                    add(center + direction * radius, closestPoints[lane], direction, radius - distance);
+                    continue;
+                }
+
+                Vector3 corners[3];
+                for (size_t vertex = 0; vertex < 3; ++vertex) corners[vertex] = Vector3(packet.vertices[vertex][0][lane], packet.vertices[vertex][1][lane], packet.vertices[vertex][2][lane]);
+                Vector3 direction = frameA.position - frameB.ToWorldPoint((corners[0] + corners[1] + corners[2]) / 3.0f) + Vector3(1e-6f);
+                CollisionInfo info = GJK(colliderA, frameA, ColliderVariant(TriangleCollider(corners[0], corners[1], corners[2])), frameB, direction, hints);
+                if (!info) continue;
+                for (size_t index = 0; index < info.contactCount; ++index) add(info.contacts[index].pointA, info.contacts[index].pointB, info.normal, Dot(info.contacts[index].pointA - info.contacts[index].pointB, info.normal));
             }
-            
-            // Apply friction impulses.
-            if (!physicsA.IsStationary()) physicsA.ApplyLinearImpulse(-frictionImpulse);
-            if (!physicsB.IsStationary()) physicsB.ApplyLinearImpulse(frictionImpulse);
-            
-            // Apply angular friction impulses.
-            if (!physicsA.IsStationary()) physicsA.ApplyAngularImpulse(Cross(relativeA, -frictionImpulse), inverseInertiaTensorWorldA);
-            if (!physicsB.IsStationary()) physicsB.ApplyAngularImpulse(Cross(relativeB, frictionImpulse), inverseInertiaTensorWorldB);
+        });
+
+        CollisionInfo info;
+        if (contactCount == 0)
+        {
+            info.status = CollisionInfo::Status::Separated;
+            return info;
         }
-        
-        // Separate objects.
-        float totalInverseMass = physicsA.GetInverseMass() + physicsB.GetInverseMass();
-        if (totalInverseMass > 0)
+
+        // One normal per manifold, the deepest triangle's. Contacts on triangles facing elsewhere get their turn when they are the deepest.
+        size_t deepest = static_cast<size_t>(std::max_element(depths.begin(), depths.begin() + contactCount) - depths.begin());
+        info.status = CollisionInfo::Status::Colliding;
+        info.normal = normals[deepest];
+        info.depth = depths[deepest];
+        std::array<Vector3, s_MaxMeshContacts> points;
+        std::array<float, s_MaxMeshContacts> pointDepths;
+        std::array<size_t, s_MaxMeshContacts> kept;
+        size_t keptCount = 0;
+        for (size_t index = 0; index < contactCount; ++index)
         {
-            if (!physicsA.IsStationary()) transformA.TranslateBy(-collision.normal * collision.depth * (physicsA.GetInverseMass() / totalInverseMass));
-            if (!physicsB.IsStationary()) transformB.TranslateBy(collision.normal * collision.depth * (physicsB.GetInverseMass() / totalInverseMass));
+            if (Dot(normals[index], info.normal) < s_MeshNormalTolerance) continue;
+            points[keptCount] = contacts[index].pointA;
+            pointDepths[keptCount] = Dot(contacts[index].pointA - contacts[index].pointB, info.normal);
+            kept[keptCount++] = index;
         }
+        std::array<size_t, s_MaxContacts> selected;
+        size_t selectedCount = ReduceContacts(points.data(), pointDepths.data(), keptCount, info.normal, selected);
+        for (size_t index = 0; index < selectedCount; ++index) info.AddContact(contacts[kept[selected[index]]].pointA, contacts[kept[selected[index]]].pointB);
+        return info;
     }
 
-    void Solver::Solve(World& world, float deltaTime)
+    void Solver::ClosestPoints(const Capsule& capsuleA, const Capsule& capsuleB, float& s, float& t)
     {
-        deltaTime = Clamp(deltaTime, 0.0f, 1.0f);
-        auto view = world.View<Transform, Physics>();
-        for (auto [handle, transform, physics] : view)
+        // Same as for box edges, the parameters run from minus to plus the half length.
+        Vector3 difference = capsuleA.center - capsuleB.center;
+        float b = Dot(capsuleA.axis, capsuleB.axis);
+        float c = Dot(capsuleA.axis, difference);
+        float f = Dot(capsuleB.axis, difference);
+        float denominator = 1.0f - b * b;
+        s = (denominator > 1e-6f) ? Clamp((b * f - c) / denominator, -capsuleA.halfLength, capsuleA.halfLength) : 0.0f;
+        t = Clamp(b * s + f, -capsuleB.halfLength, capsuleB.halfLength);
+        s = Clamp(b * t - c, -capsuleA.halfLength, capsuleA.halfLength);
+    }
+    Solver::CollisionInfo Solver::TestSphereSphere(const Vector3& centerA, float radiusA, const Vector3& centerB, float radiusB)
+    {
+        Vector3 offset = centerB - centerA;
+        float distanceSquared = LengthSquared(offset);
+
+        CollisionInfo info;
+        if (distanceSquared > Square(radiusA + radiusB))
         {
-            if (physics.IsStationary()) continue;
+            info.status = CollisionInfo::Status::Separated;
+            return info;
+        }
+
+        float distance = SquareRoot(distanceSquared);
+        info.status = CollisionInfo::Status::Colliding;
+        info.normal = (distance > 1e-6f) ? offset / distance : Vector3(0.0f, 0.0f, 1.0f);
+        info.depth = radiusA + radiusB - distance;
+        info.AddContact(centerA + info.normal * radiusA, centerB - info.normal * radiusB);
+        return info;
+    }
+    Solver::CollisionInfo Solver::TestSphereBox(const Vector3& center, float radius, const Box& box)
+    {
+        CollisionInfo info;
+        Vector3 offset = center - box.center;
+        Vector3 local = Vector3(Dot(offset, box.axes[0]), Dot(offset, box.axes[1]), Dot(offset, box.axes[2]));
+        Vector3 clamped = Vector3(
+            Clamp(local.x, -box.halfExtents.x, box.halfExtents.x),
+            Clamp(local.y, -box.halfExtents.y, box.halfExtents.y),
+            Clamp(local.z, -box.halfExtents.z, box.halfExtents.z)
+        );
+
+        if (clamped.x != local.x || clamped.y != local.y || clamped.z != local.z)
+        {
+            // Center outside of the box, the contact is on the closest point.
+            Vector3 closest = box.center + box.axes[0] * clamped.x + box.axes[1] * clamped.y + box.axes[2] * clamped.z;
+            Vector3 difference = closest - center;
+            float distanceSquared = LengthSquared(difference);
+            if (distanceSquared > Square(radius))
+            {
+                info.status = CollisionInfo::Status::Separated;
+                return info;
+            }
 
-            physics.ApplyForce(m_Gravity * physics.GetMass() * Vector3(0.0f, 0.0f, -1.0f));
-            
-            Matrix3 rotationMatrix = Matrix3(transform.GetRotationMatrix());
-            Matrix3 inverseScalingMatrix = Matrix3(transform.GetInverseScalingMatrix());
-            Matrix3 inverseInertiaTensorWorld = rotationMatrix * inverseScalingMatrix * physics.GetInverseInertiaTensor() * inverseScalingMatrix * Transposed(rotationMatrix);
-            physics.Integrate(deltaTime, inverseInertiaTensorWorld);
+            float distance = SquareRoot(distanceSquared);
+            info.status = CollisionInfo::Status::Colliding;
+            info.normal = difference / distance;
+            info.depth = radius - distance;
+            info.AddContact(center + info.normal * radius, closest);
+            return info;
+        }
 
-            transform.TranslateBy(physics.GetVelocity() * deltaTime);
-            
-            Vector3 angularVelocity = physics.GetAngularVelocity();
-            float deltaAngle = Length(angularVelocity) * deltaTime;
-            if (deltaAngle > 1e-6f)
+        // Center inside the box, push the sphere out through the closest face.
+        size_t axis = 0;
+        float faceDistance = box.halfExtents[0] - Abs(local[0]);
+        for (size_t index = 1; index < 3; ++index)
+        {
+            float distance = box.halfExtents[index] - Abs(local[index]);
+            if (distance < faceDistance)
             {
-                Vector3 rotationAxis = Normalized(angularVelocity);
-                transform.RotateAround(rotationAxis, deltaAngle);
+                faceDistance = distance;
+                axis = index;
             }
-            
-            physics.ResetAccumulators();
         }
-        for (auto [handleA, transformA, physicsA] : view)
+        Vector3 faceNormal = box.axes[axis] * Sign(local[axis]);
+
+        info.status = CollisionInfo::Status::Colliding;
+        info.normal = -faceNormal;
+        info.depth = radius + faceDistance;
+        info.AddContact(center - faceNormal * radius, center + faceNormal * faceDistance);
+        return info;
+    }
+    Solver::CollisionInfo Solver::TestBoxBox(const Box& boxA, const Box& boxB)
+    {
+        CollisionInfo info;
+        Vector3 offset = boxB.center - boxA.center;
+
+        // Separating axis test over both boxes' face normals and the cross products of their edges.
+        size_t bestAxis = 0;
+        Vector3 bestNormal;
+        float bestOverlap = std::numeric_limits<float>::infinity();
+        auto testAxis = [&](Vector3 axis, size_t index) -> bool
+        {
+            float length = Length(axis);
+            if (length < 1e-5f) return true;    // Parallel edges, already covered by the face normals.
+            axis /= length;
+
+            float projectionA = boxA.halfExtents.x * Abs(Dot(boxA.axes[0], axis)) + boxA.halfExtents.y * Abs(Dot(boxA.axes[1], axis)) + boxA.halfExtents.z * Abs(Dot(boxA.axes[2], axis));
+            float projectionB = boxB.halfExtents.x * Abs(Dot(boxB.axes[0], axis)) + boxB.halfExtents.y * Abs(Dot(boxB.axes[1], axis)) + boxB.halfExtents.z * Abs(Dot(boxB.axes[2], axis));
+            float overlap = projectionA + projectionB - Abs(Dot(offset, axis));
+            if (overlap < 0.0f) return false;
+
+            // Favour face contacts, edge axes have to be clearly better to be picked.
+            if ((index < 6) ? overlap < bestOverlap : overlap * 1.05f + 1e-3f < bestOverlap)
+            {
+                bestOverlap = overlap;
+                bestNormal = axis;
+                bestAxis = index;
+            }
+            return true;
+        };
+
+        for (size_t index = 0; index < 3; ++index) if (!testAxis(boxA.axes[index], index)) return info.status = CollisionInfo::Status::Separated, info;
+        for (size_t index = 0; index < 3; ++index) if (!testAxis(boxB.axes[index], 3 + index)) return info.status = CollisionInfo::Status::Separated, info;
+        for (size_t i = 0; i < 3; ++i)
         {
-            for (auto [handleB, transformB, physicsB] : view)
+            for (size_t j = 0; j < 3; ++j)
             {
-                if (handleA <= handleB) continue;
-                if (physicsA.IsStationary() && physicsB.IsStationary()) continue; 
-                CollisionInfo collision = GJK(physicsA.GetCollider(), transformA, physicsB.GetCollider(), transformB);
-                if (collision) ResolveCollision(physicsA, transformA, physicsB, transformB, collision);
-                // else
-                // {
-                //     if (collision.status == CollisionInfo::Status::GJKFailed) std::cout << std::format("GJK failed between object {} and {}\n", (int) handleA, (int) handleB);
-                //     else if (collision.status == CollisionInfo::Status::EPAFailed) std::cout << std::format("EPA failed between object {} and {}\n", (int) handleA, (int) handleB);
-                // }
+                if (!testAxis(Cross(boxA.axes[i], boxB.axes[j]), 6 + 3 * i + j)) return info.status = CollisionInfo::Status::Separated, info;
             }
         }
+
+        if (Dot(bestNormal, offset) < 0.0f) bestNormal = -bestNormal;
+        info.status = CollisionInfo::Status::Colliding;
+        info.normal = bestNormal;
+        info.depth = bestOverlap;
+
+        if (bestAxis >= 6)
+        {
+            // Edge against edge, take the closest points between the two supporting edges.
+            size_t i = (bestAxis - 6) / 3;
+            size_t j = (bestAxis - 6) % 3;
+            Vector3 pointA = boxA.center;
+            Vector3 pointB = boxB.center;
+            for (size_t index = 0; index < 3; ++index)
+            {
+                if (index != i) pointA += boxA.axes[index] * boxA.halfExtents[index] * Sign(Dot(boxA.axes[index], bestNormal));
+                if (index != j) pointB -= boxB.axes[index] * boxB.halfExtents[index] * Sign(Dot(boxB.axes[index], bestNormal));
+            }
+
+            Vector3 difference = pointA - pointB;
+            float b = Dot(boxA.axes[i], boxB.axes[j]);
+            float c = Dot(boxA.axes[i], difference);
+            float f = Dot(boxB.axes[j], difference);
+            float denominator = 1.0f - b * b;
+            float s = (denominator > 1e-6f) ? Clamp((b * f - c) / denominator, -boxA.halfExtents[i], boxA.halfExtents[i]) : 0.0f;
+            float t = Clamp(b * s + f, -boxB.halfExtents[j], boxB.halfExtents[j]);
+            s = Clamp(b * t - c, -boxA.halfExtents[i], boxA.halfExtents[i]);
+
+            info.AddContact(pointA + boxA.axes[i] * s, pointB + boxB.axes[j] * t);
+            return info;
+        }
+
+        // Face contact, clip the incident face against the side planes of the reference face.
+        bool referenceIsA = bestAxis < 3;
+        const Box& reference = referenceIsA ? boxA : boxB;
+        const Box& incident = referenceIsA ? boxB : boxA;
+        size_t referenceAxis = bestAxis % 3;
+        Vector3 referenceNormal = referenceIsA ? bestNormal : -bestNormal;
+
+        size_t incidentAxis = 0;
+        for (size_t index = 1; index < 3; ++index)
+        {
+            if (Abs(Dot(incident.axes[index], referenceNormal)) > Abs(Dot(incident.axes[incidentAxis], referenceNormal))) incidentAxis = index;
+        }
+        Vector3 incidentNormal = incident.axes[incidentAxis] * -Sign(Dot(incident.axes[incidentAxis], referenceNormal));
+        Vector3 incidentCenter = incident.center + incidentNormal * incident.halfExtents[incidentAxis];
+        Vector3 u = incident.axes[(incidentAxis + 1) % 3] * incident.halfExtents[(incidentAxis + 1) % 3];
+        Vector3 v = incident.axes[(incidentAxis + 2) % 3] * incident.halfExtents[(incidentAxis + 2) % 3];
+
+        std::array<Vector3, 8> polygon = { incidentCenter + u + v, incidentCenter - u + v, incidentCenter - u - v, incidentCenter + u - v };
+        std::array<Vector3, 8> clipped;
+        size_t count = 4;
+        for (size_t side = 1; side < 3; ++side)
+        {
+            size_t axis = (referenceAxis + side) % 3;
+            for (float sign : { 1.0f, -1.0f })
+            {
+                Vector3 planeNormal = reference.axes[axis] * sign;
+                float planeOffset = Dot(planeNormal, reference.center) + reference.halfExtents[axis];
+                size_t clippedCount = 0;
+                for (size_t index = 0; index < count; ++index)
+                {
+                    const Vector3& start = polygon[index];
+                    const Vector3& end = polygon[(index + 1) % count];
+                    float distanceStart = Dot(planeNormal, start) - planeOffset;
+                    float distanceEnd = Dot(planeNormal, end) - planeOffset;
+                    if (distanceStart <= 0.0f) clipped[clippedCount++] = start;
+                    if ((distanceStart < 0.0f) != (distanceEnd < 0.0f)) clipped[clippedCount++] = start + (end - start) * (distanceStart / (distanceStart - distanceEnd));
+                }
+                polygon = clipped;
+                count = clippedCount;
+            }
+        }
+
+        // Keep the clipped points that lie below the reference face, reduced to the four spanning the largest area.
+        Vector3 referenceCenter = reference.center + referenceNormal * reference.halfExtents[referenceAxis];
+        std::array<Vector3, 8> points;
+        std::array<float, 8> depths;
+        size_t penetrating = 0;
+        size_t deepest = 0;
+        for (size_t index = 0; index < count; ++index)
+        {
+            float separation = Dot(polygon[index] - referenceCenter, referenceNormal);
+            if (separation < Dot(polygon[deepest] - referenceCenter, referenceNormal)) deepest = index;
+            if (separation > 0.0f) continue;
+            points[penetrating] = polygon[index];
+            depths[penetrating++] = -separation;
+        }
+        if (penetrating == 0)
+        {
+            points[penetrating] = (count > 0) ? polygon[deepest] : incidentCenter;
+            depths[penetrating++] = 0.0f;
+        }
+
+        std::array<size_t, s_MaxContacts> selected;
+        size_t selectedCount = ReduceContacts(points.data(), depths.data(), penetrating, referenceNormal, selected);
+        for (size_t index = 0; index < selectedCount; ++index)
+        {
+            Vector3 incidentPoint = points[selected[index]];
+            Vector3 referencePoint = incidentPoint - referenceNormal * Dot(incidentPoint - referenceCenter, referenceNormal);
+            if (referenceIsA) info.AddContact(referencePoint, incidentPoint);
+            else info.AddContact(incidentPoint, referencePoint);
+        }
+        return info;
+    }
+    Solver::CollisionInfo Solver::Combined(const CollisionInfo& first, const CollisionInfo& second)
+    {
+        // One manifold from two single point tests along the same segment, the deeper one leads with its normal.
+        if (second.status != CollisionInfo::Status::Colliding) return first;
+        if (first.status != CollisionInfo::Status::Colliding) return second;
+        bool firstDeeper = first.depth >= second.depth;
+        CollisionInfo info = firstDeeper ? first : second;
+        const CollisionInfo& other = firstDeeper ? second : first;
+        info.AddContact(other.contacts[0].pointA, other.contacts[0].pointB);
+        return info;
+    }
+
+    size_t Solver::ReduceContacts(const Vector3* points, const float* depths, size_t count, const Vector3& normal, std::array<size_t, s_MaxContacts>& selected)
+    {
+        // Always keep the deepest point, and put it first.
+        size_t first = 0;
+        for (size_t index = 1; index < count; ++index) if (depths[index] > depths[first]) first = index;
+        selected[0] = first;
+        if (count <= s_MaxContacts)
+        {
+            for (size_t index = 0, next = 1; index < count; ++index) if (index != first) selected[next++] = index;
+            return count;
+        }
+
+        // Then the point furthest from it, and the two spanning the largest area on either side of that edge.
+        size_t second = first;
+        float furthest = -1.0f;
+        for (size_t index = 0; index < count; ++index)
+        {
+            float distance = LengthSquared(points[index] - points[first]);
+            if (distance > furthest)
+            {
+                furthest = distance;
+                second = index;
+            }
+        }
+
+        size_t third = first;
+        size_t fourth = first;
+        float maxArea = -std::numeric_limits<float>::infinity();
+        float minArea = std::numeric_limits<float>::infinity();
+        Vector3 edge = points[second] - points[first];
+        for (size_t index = 0; index < count; ++index)
+        {
+            if (index == first || index == second) continue;
+            float area = Dot(Cross(edge, points[index] - points[first]), normal);
+            if (area > maxArea)
+            {
+                maxArea = area;
+                third = index;
+            }
+            if (area < minArea)
+            {
+                minArea = area;
+                fourth = index;
+            }
+        }
+        if (third == fourth)
+        {
+            for (size_t index = 0; index < count; ++index) if (index != first && index != second && index != third) fourth = index;
+        }
+
+        selected = { first, second, third, fourth };
+        return s_MaxContacts;
+    }
+
+    void Solver::UpdateManifold(Manifold& manifold, const CollisionInfo& collision, const Frame& frameA, const Frame& frameB)
+    {
+        // Carry the cached points along with the bodies, dropping those that separated or slid apart since they were found.
+        std::array<ManifoldPoint, 2 * s_MaxContacts> candidates;
+        size_t cachedCount = 0;
+        for (size_t index = 0; index < manifold.count; ++index)
+        {
+            ManifoldPoint point = manifold.points[index];
+            point.pointA = frameA.ToWorldPoint(point.localPointA);
+            point.pointB = frameB.ToWorldPoint(point.localPointB);
+            Vector3 offset = point.pointA - point.pointB;
+            point.depth = Dot(offset, collision.normal);
+            if (point.depth < -s_ContactBreakingDistance || LengthSquared(offset - collision.normal * point.depth) > Square(s_ContactBreakingDistance)) continue;
+            candidates[cachedCount++] = point;
+        }
+
+        // New contacts replace the cached point they landed on, or join the set.
+        size_t candidateCount = cachedCount;
+        for (size_t index = 0; index < collision.contactCount; ++index)
+        {
+            const Contact& contact = collision.contacts[index];
+            ManifoldPoint point;
+            point.localPointA = frameA.ToLocalPoint(contact.pointA);
+            point.localPointB = frameB.ToLocalPoint(contact.pointB);
+            point.pointA = contact.pointA;
+            point.pointB = contact.pointB;
+            point.depth = Dot(contact.pointA - contact.pointB, collision.normal);
+
+            size_t match = candidateCount;
+            for (size_t cached = 0; cached < cachedCount; ++cached)
+            {
+                if (LengthSquared(candidates[cached].pointA - contact.pointA) < Square(s_ContactBreakingDistance)) match = cached;
+            }
+            if (match < cachedCount)
+            {
+                point.normalImpulse = candidates[match].normalImpulse;
+                point.tangentImpulse = candidates[match].tangentImpulse;
+            }
+            candidates[match] = point;
+            if (match == candidateCount) ++candidateCount;
+        }
+
+        std::array<Vector3, 2 * s_MaxContacts> points;
+        std::array<float, 2 * s_MaxContacts> depths;
+        for (size_t index = 0; index < candidateCount; ++index)
+        {
+            points[index] = candidates[index].pointA;
+            depths[index] = candidates[index].depth;
+        }
+        std::array<size_t, s_MaxContacts> selected;
+        manifold.count = ReduceContacts(points.data(), depths.data(), candidateCount, collision.normal, selected);
+        for (size_t index = 0; index < manifold.count; ++index) manifold.points[index] = candidates[selected[index]];
+        manifold.normal = collision.normal;
+    }
+
+    void Solver::ContactConstraints::resize(size_t count)
+    {
+        bodyA.resize(count);
+        bodyB.resize(count);
+        normal.resize(count);
+        tangentU.resize(count);
+        tangentV.resize(count);
+        relativeA.resize(count);
+        relativeB.resize(count);
+        anchorA.resize(count);
+        anchorB.resize(count);
+        normalMass.resize(count);
+        tangentMassU.resize(count);
+        tangentMassV.resize(count);
+        normalImpulse.resize(count);
+        tangentImpulseU.resize(count);
+        tangentImpulseV.resize(count);
+        bias.resize(count);
+        friction.resize(count);
+        points.resize(count);
+    }
+    void Solver::BodyStates::resize(size_t count)
+    {
+        position.resize(count);
+        orientation.resize(count);
+        velocity.resize(count);
+        angularVelocity.resize(count);
+        acceleration.resize(count);
+        angularAcceleration.resize(count);
+        inverseMass.resize(count);
+        inverseInertia.resize(count);
+        drag.resize(count);
+        moving.resize(count);
+    }
+
+    void Solver::ApplyImpulse(uint32_t bodyA, uint32_t bodyB, const Vector3& relativeA, const Vector3& relativeB, const Vector3& impulse)
+    {
+        // Stationary bodies are shared between islands, they are never written to.
+        if (m_States.inverseMass[bodyA] > 0.0f)
+        {
+            m_States.velocity[bodyA] -= impulse * m_States.inverseMass[bodyA];
+            m_States.angularVelocity[bodyA] -= m_States.inverseInertia[bodyA] * Cross(relativeA, impulse);
+        }
+        if (m_States.inverseMass[bodyB] > 0.0f)
+        {
+            m_States.velocity[bodyB] += impulse * m_States.inverseMass[bodyB];
+            m_States.angularVelocity[bodyB] += m_States.inverseInertia[bodyB] * Cross(relativeB, impulse);
+        }
+    }
+
+    void Solver::UpdateNarrowphase()
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        // Each pair only reads the start of step frames and writes its own cache entry, so pairs are tested in any order on any thread.
+        for (NarrowphaseBuffer& buffer : m_NarrowphaseBuffers) buffer.touching.clear();
+        ParallelFor(m_NarrowphasePairs.size(), s_PairGrain, [this](size_t begin, size_t end)
+        {
+            NarrowphaseBuffer& buffer = m_NarrowphaseBuffers[ThreadPool::GetThreadIndex()];
+            auto finish = [this, &buffer](size_t index, CollisionInfo collision)
+            {
+                NarrowphasePair& pair = m_NarrowphasePairs[index];
+                if (!collision)
+                {
+                    pair.cache->manifold.count = 0;
+                    return;
+                }
+                UpdateManifold(pair.cache->manifold, collision, m_Bodies[pair.bodyA].frame, m_Bodies[pair.bodyB].frame);
+                buffer.touching.push_back(static_cast<uint32_t>(index));
+            };
+            auto collide = [this, &finish](size_t index)
+            {
+                NarrowphasePair& pair = m_NarrowphasePairs[index];
+                const Body& bodyA = m_Bodies[pair.bodyA];
+                const Body& bodyB = m_Bodies[pair.bodyB];
+                finish(index, Collide(bodyA.physics->GetCollider(), bodyA.frame, bodyB.physics->GetCollider(), bodyB.frame, pair.cache->direction, pair.cache->hints, pair.cached));
+            };
+
+            // Ellipsoid pairs, round shapes a non uniform scale took off their closed form test, are screened a batch at a time.
+            // Most candidates from the broadphase only overlap in their bounds, those never reach the scalar GJK.
+            GJKBatch batch;
+            auto flush = [this, &batch, &buffer, &finish, &collide]()
+            {
+                // Lanes past the count of a partial batch repeat the first pair, so they hold finite values and are masked off.
+                const NarrowphasePair& first = m_NarrowphasePairs[batch.pairs[0]];
+                for (size_t lane = batch.count; lane < LaneCount; ++lane)
+                {
+                    SetRoundedBox(batch.a, lane, m_Bodies[first.bodyA].physics->GetCollider(), m_Bodies[first.bodyA].frame);
+                    SetRoundedBox(batch.b, lane, m_Bodies[first.bodyB].physics->GetCollider(), m_Bodies[first.bodyB].frame);
+                    for (size_t axis = 0; axis < 3; ++axis) batch.direction[axis][lane] = batch.direction[axis][0];
+                }
+
+                uint32_t overlapping = BatchGJK(batch);
+                buffer.statistics.gjkBatchedPairs += batch.count;
+                for (size_t lane = 0; lane < batch.count; ++lane)
+                {
+                    // The last search direction seeds the scalar GJK and next step's batch.
+                    NarrowphasePair& pair = m_NarrowphasePairs[batch.pairs[lane]];
+                    PairCache& cache = *pair.cache;
+                    cache.direction = Vector3(batch.direction[0][lane], batch.direction[1][lane], batch.direction[2][lane]);
+                    if (batch.contained >> lane & 1)
+                    {
+                        // Straight to EPA, the scalar GJK would only build the same tetrahedron again.
+                        Simplex simplex;
+                        Support* supports[4] = { &simplex.A, &simplex.B, &simplex.C, &simplex.D };
+                        for (size_t vertex = 0; vertex < 4; ++vertex)
+                        {
+                            supports[vertex]->point = Vector3(batch.simplex[vertex][0][0][lane], batch.simplex[vertex][0][1][lane], batch.simplex[vertex][0][2][lane]);
+                            supports[vertex]->pointFromA = Vector3(batch.simplex[vertex][1][0][lane], batch.simplex[vertex][1][1][lane], batch.simplex[vertex][1][2][lane]);
+                            supports[vertex]->pointFromB = supports[vertex]->pointFromA - supports[vertex]->point;
+                        }
+                        simplex.count = 4;
+                        const Body& bodyA = m_Bodies[pair.bodyA];
+                        const Body& bodyB = m_Bodies[pair.bodyB];
+                        finish(batch.pairs[lane], EPA(simplex, bodyA.physics->GetCollider(), bodyA.frame, bodyB.physics->GetCollider(), bodyB.frame, cache.hints));
+                    }
+                    else if (overlapping >> lane & 1) collide(batch.pairs[lane]);
+                    else
+                    {
+                        ++buffer.statistics.gjkBatchedSeparations;
+                        cache.manifold.count = 0;
+                    }
+                }
+                batch.count = 0;
+            };
+            for (size_t index = begin; index < end; ++index)
+            {
+                NarrowphasePair& pair = m_NarrowphasePairs[index];
+                const Body& bodyA = m_Bodies[pair.bodyA];
+                const Body& bodyB = m_Bodies[pair.bodyB];
+                const ColliderVariant& colliderA = bodyA.physics->GetCollider();
+                const ColliderVariant& colliderB = bodyB.physics->GetCollider();
+                // Pairs with no closed form test at all, like cubes against capsules, ran slower through the batch than through the scalar GJK.
+                bool batchable = m_BatchedGJKEnabled && IsRoundedBox(colliderA) && IsRoundedBox(colliderB) &&
+                    s_CollisionTable[static_cast<size_t>(colliderA.GetShape())][static_cast<size_t>(colliderB.GetShape())] != static_cast<CollisionTest>(&Solver::GJK);
+                if (!batchable)
+                {
+                    collide(index);
+                    continue;
+                }
+                CollisionTest test = GetCollisionTest(colliderA, bodyA.frame, colliderB, bodyB.frame);
+                if (test != static_cast<CollisionTest>(&Solver::GJK))
+                {
+                    finish(index, (this->*test)(colliderA, bodyA.frame, colliderB, bodyB.frame));
+                    continue;
+                }
+
+                size_t lane = batch.count++;
+                SetRoundedBox(batch.a, lane, colliderA, bodyA.frame);
+                SetRoundedBox(batch.b, lane, colliderB, bodyB.frame);
+                Vector3 direction = pair.cache->direction;
+                if (!pair.cached || LengthSquared(direction) < 1e-12f) direction = bodyA.frame.position - bodyB.frame.position + Vector3(1e-6f);
+                for (size_t axis = 0; axis < 3; ++axis) batch.direction[axis][lane] = direction[axis];
+                batch.pairs[lane] = static_cast<uint32_t>(index);
+                if (batch.count == LaneCount) flush();
+            }
+            if (batch.count > 0) flush();
+        });
+
+        // Merge in pair order, so islands and contact rows come out the same for any thread count.
+        m_Touching.clear();
+        for (NarrowphaseBuffer& buffer : m_NarrowphaseBuffers)
+        {
+            m_Touching.insert(m_Touching.end(), buffer.touching.begin(), buffer.touching.end());
+            m_Statistics.gjkQueries += buffer.statistics.gjkQueries;
+            m_Statistics.gjkCacheHits += buffer.statistics.gjkCacheHits;
+            m_Statistics.gjkIterations += buffer.statistics.gjkIterations;
+            m_Statistics.gjkBatchedPairs += buffer.statistics.gjkBatchedPairs;
+            m_Statistics.gjkBatchedSeparations += buffer.statistics.gjkBatchedSeparations;
+            m_Statistics.meshTriangles += buffer.statistics.meshTriangles;
+            m_Statistics.meshTriangleTests += buffer.statistics.meshTriangleTests;
+            m_Statistics.epaQueries += buffer.statistics.epaQueries;
+            m_Statistics.epaIterations += buffer.statistics.epaIterations;
+            buffer.statistics = Statistics();
+        }
+        std::sort(m_Touching.begin(), m_Touching.end());
+
+        m_Manifolds.clear();
+        for (uint32_t index : m_Touching)
+        {
+            const NarrowphasePair& pair = m_NarrowphasePairs[index];
+            const Body& bodyA = m_Bodies[pair.bodyA];
+            const Body& bodyB = m_Bodies[pair.bodyB];
+
+            // Touching an awake body wakes a sleeping one, the rest of its island follows at the end of the step.
+            if (bodyA.physics->IsSleeping()) WakeBody(pair.bodyA);
+            if (bodyB.physics->IsSleeping()) WakeBody(pair.bodyB);
+            m_Manifolds.push_back({ pair.bodyA, pair.bodyB, &pair.cache->manifold, 0, 0 });
+            if (!bodyA.physics->IsStationary() && !bodyB.physics->IsStationary()) MergeIslands(pair.bodyA, pair.bodyB);
+        }
+        m_Statistics.narrowphasePairs = m_NarrowphasePairs.size();
+        m_Statistics.narrowphaseTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void Solver::SetDynamics(uint32_t index)
+    {
+        const Body& body = m_Bodies[index];
+        const Physics& physics = *body.physics;
+        m_States.inverseMass[index] = physics.GetInverseMass();
+
+        if (IsUniform(body.frame.scale))
+        {
+            // Uniform scale s turns the inertia into s^2 * I, so R * S^-1 * I^-1 * S^-1 * R^T is exact. The outer factors are the frame's inverse linear part and its transpose.
+            m_States.inverseInertia[index] = Transposed(body.frame.inverseLinear) * physics.GetInverseInertiaTensor() * body.frame.inverseLinear;
+        }
+        else
+        {
+            // Other scales stretch the mass instead. Its second moment tr(I) / 2 - I becomes S * M * S, and the inertia is rebuilt from that.
+            Matrix3 moment = physics.GetInertiaTensor();
+            moment = Matrix3(0.5f * (moment[0][0] + moment[1][1] + moment[2][2])) - moment;
+            for (size_t column = 0; column < 3; ++column) for (size_t row = 0; row < 3; ++row) moment[column][row] *= body.frame.scale[column] * body.frame.scale[row];
+            Matrix3 inertia = Matrix3(moment[0][0] + moment[1][1] + moment[2][2]) - moment;
+            m_States.inverseInertia[index] = body.frame.rotation * Inversed(inertia) * Transposed(body.frame.rotation);
+        }
+        m_Statistics.matrixProducts += 2;
+        m_States.acceleration[index] = (physics.GetAccumulatedForce() + m_Gravity * physics.GetMass() * Vector3(0.0f, 0.0f, -1.0f)) * m_States.inverseMass[index];
+        m_States.angularAcceleration[index] = m_States.inverseInertia[index] * physics.GetAccumulatedTorque();
+        m_States.drag[index] = physics.GetDrag();
+        m_States.moving[index] = 1.0f;
+    }
+    void Solver::WakeBody(uint32_t index)
+    {
+        m_Bodies[index].physics->Wake();
+        SetDynamics(index);
+    }
+
+    uint32_t Solver::FindIsland(uint32_t body)
+    {
+        while (m_IslandParents[body] != body)
+        {
+            m_IslandParents[body] = m_IslandParents[m_IslandParents[body]];
+            body = m_IslandParents[body];
+        }
+        return body;
+    }
+    void Solver::MergeIslands(uint32_t bodyA, uint32_t bodyB)
+    {
+        // The lowest body index ends up as the root, independent of the order pairs are merged in.
+        uint32_t islandA = FindIsland(bodyA);
+        uint32_t islandB = FindIsland(bodyB);
+        if (islandA < islandB) m_IslandParents[islandB] = islandA;
+        else m_IslandParents[islandA] = islandB;
+    }
+    void Solver::UpdateSleep(float deltaTime)
+    {
+        m_IslandSleepTimes.assign(m_Bodies.size(), std::numeric_limits<float>::infinity());
+        for (uint32_t index = 0; index < m_Bodies.size(); ++index)
+        {
+            Physics& physics = *m_Bodies[index].physics;
+            if (physics.IsStationary()) continue;
+            if (!physics.IsSleeping())
+            {
+                bool still = LengthSquared(m_States.velocity[index]) < Square(s_SleepLinearVelocity) && LengthSquared(m_States.angularVelocity[index]) < Square(s_SleepAngularVelocity);
+                physics.SetSleepTime(still ? physics.GetSleepTime() + deltaTime : 0.0f);
+            }
+            float& islandSleepTime = m_IslandSleepTimes[FindIsland(index)];
+            islandSleepTime = Min(islandSleepTime, physics.GetSleepTime());
+        }
+
+        // Islands fall asleep and wake up as a whole.
+        for (uint32_t index = 0; index < m_Bodies.size(); ++index)
+        {
+            Physics& physics = *m_Bodies[index].physics;
+            if (physics.IsStationary()) continue;
+            uint32_t island = FindIsland(index);
+            if (m_SleepEnabled && m_IslandSleepTimes[island] >= s_TimeToSleep)
+            {
+                physics.Sleep();
+                ++m_Statistics.sleepingBodies;
+                continue;
+            }
+            physics.Wake();
+            if (island == index) ++m_Statistics.islands;
+        }
+    }
+
+    void Solver::BuildIslands()
+    {
+        // Counting sort by island root keeps the broadphase order of the manifolds within each island.
+        m_IslandOffsets.assign(m_Bodies.size() + 1, 0);
+        for (ContactManifold& contact : m_Manifolds)
+        {
+            contact.island = FindIsland(m_Bodies[contact.bodyA].physics->IsStationary() ? contact.bodyB : contact.bodyA);
+            ++m_IslandOffsets[contact.island + 1];
+        }
+        for (size_t index = 1; index < m_IslandOffsets.size(); ++index) m_IslandOffsets[index] += m_IslandOffsets[index - 1];
+        m_SortedManifolds.resize(m_Manifolds.size());
+        for (const ContactManifold& contact : m_Manifolds) m_SortedManifolds[m_IslandOffsets[contact.island]++] = contact;
+        std::swap(m_Manifolds, m_SortedManifolds);
+
+        m_Islands.clear();
+        m_ColorOffsets.clear();
+        m_BodyColors.resize(m_Bodies.size());
+        for (uint32_t first = 0; first < m_Manifolds.size();)
+        {
+            uint32_t last = first;
+            size_t rowCount = 0;
+            while (last < m_Manifolds.size() && m_Manifolds[last].island == m_Manifolds[first].island) rowCount += m_Manifolds[last++].manifold->count;
+            m_Islands.push_back({ first, last - first, 0, 0 });
+
+            // The split depends on the island alone, never on the thread count, so results don't either.
+            if (rowCount >= s_MinColoredRows) ColorIsland(m_Islands.back());
+            first = last;
+        }
+    }
+    void Solver::ColorIsland(Island& island)
+    {
+        // Greedy coloring, manifolds of one color share no moving body and can be solved at the same time.
+        ContactManifold* manifolds = m_Manifolds.data() + island.firstManifold;
+        for (size_t index = 0; index < island.manifoldCount; ++index)
+        {
+            m_BodyColors[manifolds[index].bodyA] = 0;
+            m_BodyColors[manifolds[index].bodyB] = 0;
+        }
+
+        std::array<uint32_t, s_MaxColors + 1> offsets = {};
+        for (size_t index = 0; index < island.manifoldCount; ++index)
+        {
+            ContactManifold& contact = manifolds[index];
+            bool movingA = !m_Bodies[contact.bodyA].physics->IsStationary();
+            bool movingB = !m_Bodies[contact.bodyB].physics->IsStationary();
+            uint64_t taken = (movingA ? m_BodyColors[contact.bodyA] : 0) | (movingB ? m_BodyColors[contact.bodyB] : 0);
+            contact.color = std::min(static_cast<uint32_t>(std::countr_one(taken)), static_cast<uint32_t>(s_MaxColors - 1));
+            if (movingA) m_BodyColors[contact.bodyA] |= 1ull << contact.color;
+            if (movingB) m_BodyColors[contact.bodyB] |= 1ull << contact.color;
+            ++offsets[contact.color + 1];
+            island.colorCount = std::max(island.colorCount, contact.color + 1);
+        }
+
+        island.firstColor = static_cast<uint32_t>(m_ColorOffsets.size());
+        for (size_t color = 1; color <= island.colorCount; ++color) offsets[color] += offsets[color - 1];
+        for (size_t color = 0; color <= island.colorCount; ++color) m_ColorOffsets.push_back(island.firstManifold + offsets[color]);
+        for (size_t index = 0; index < island.manifoldCount; ++index) m_SortedManifolds[offsets[manifolds[index].color]++] = manifolds[index];
+        std::copy_n(m_SortedManifolds.begin(), island.manifoldCount, manifolds);
+
+        ++m_Statistics.coloredIslands;
+        m_Statistics.colors += island.colorCount;
+    }
+    void Solver::IntegrateVelocities(float deltaTime)
+    {
+        // Forces stay accumulated until the end of the step, every substep applies its share of them.
+        // Bodies that don't move have no acceleration or drag in their state, so they come out unchanged.
+        // A lane per body, the vectors are split into their components on the way in and merged on the way out. Bodies past the last whole batch go one at a time, all of them do with batching disabled.
+        ParallelFor(m_States.size(), s_BodyGrain, [this, deltaTime](size_t begin, size_t end)
+        {
+            auto load = [](const Vector3& first)
+            {
+                Vector3Lanes lanes;
+                LoadInterleaved(&first.x, lanes.x, lanes.y, lanes.z);
+                return lanes;
+            };
+            FloatLanes time = FloatLanes(deltaTime);
+            size_t index = begin;
+            for (; m_BatchedIntegrationEnabled && index + LaneCount <= end; index += LaneCount)
+            {
+                FloatLanes damping = FloatLanes(1.0f) - Load(&m_States.drag[index]) * time;
+                Vector3Lanes velocity = (load(m_States.velocity[index]) + load(m_States.acceleration[index]) * time) * damping;
+                Vector3Lanes angularVelocity = (load(m_States.angularVelocity[index]) + load(m_States.angularAcceleration[index]) * time) * damping;
+                StoreInterleaved(&m_States.velocity[index].x, velocity.x, velocity.y, velocity.z);
+                StoreInterleaved(&m_States.angularVelocity[index].x, angularVelocity.x, angularVelocity.y, angularVelocity.z);
+            }
+            for (; index < end; ++index)
+            {
+                float damping = 1.0f - m_States.drag[index] * deltaTime;
+                m_States.velocity[index] = (m_States.velocity[index] + m_States.acceleration[index] * deltaTime) * damping;
+                m_States.angularVelocity[index] = (m_States.angularVelocity[index] + m_States.angularAcceleration[index] * deltaTime) * damping;
+            }
+        });
+    }
+    void Solver::IntegratePositions(float deltaTime)
+    {
+        // First order on the orientation and renormalized, close to the exact rotation at any step where the solver holds up and free of trigonometry.
+        // Batched like the velocities.
+        ParallelFor(m_States.size(), s_BodyGrain, [this, deltaTime](size_t begin, size_t end)
+        {
+            size_t index = begin;
+            for (; m_BatchedIntegrationEnabled && index + LaneCount <= end; index += LaneCount)
+            {
+                FloatLanes time = Load(&m_States.moving[index]) * FloatLanes(deltaTime);
+                Vector3Lanes position;
+                Vector3Lanes velocity;
+                LoadInterleaved(&m_States.position[index].x, position.x, position.y, position.z);
+                LoadInterleaved(&m_States.velocity[index].x, velocity.x, velocity.y, velocity.z);
+                position = position + velocity * time;
+                StoreInterleaved(&m_States.position[index].x, position.x, position.y, position.z);
+
+                // (0, spin) * q added to q, then divided by its length.
+                Vector3Lanes spin;
+                FloatLanes a, b, c, d;
+                LoadInterleaved(&m_States.angularVelocity[index].x, spin.x, spin.y, spin.z);
+                LoadInterleaved(&m_States.orientation[index].a, a, b, c, d);
+                spin = spin * (time * FloatLanes(0.5f));
+                FloatLanes nextA = a - (spin.x * b + spin.y * c + spin.z * d);
+                FloatLanes nextB = b + (spin.x * a + spin.y * d - spin.z * c);
+                FloatLanes nextC = c + (spin.y * a + spin.z * b - spin.x * d);
+                FloatLanes nextD = d + (spin.z * a + spin.x * c - spin.y * b);
+                FloatLanes length = SquareRoot(nextA * nextA + nextB * nextB + nextC * nextC + nextD * nextD);
+                StoreInterleaved(&m_States.orientation[index].a, nextA / length, nextB / length, nextC / length, nextD / length);
+            }
+            for (; index < end; ++index)
+            {
+                float time = m_States.moving[index] * deltaTime;
+                m_States.position[index] += m_States.velocity[index] * time;
+                Vector3 spin = m_States.angularVelocity[index] * (0.5f * time);
+                Quaternion& orientation = m_States.orientation[index];
+                orientation = Normalized(orientation + Quaternion(0.0f, spin.x, spin.y, spin.z) * orientation);
+            }
+        });
+    }
+    void Solver::SolveIslands(float deltaTime)
+    {
+        // Small islands are solved whole, a few to a task, large ones a color at a time across all threads.
+        // Either way every row sees the same updates in the same order whatever the thread count.
+        ParallelFor(m_Islands.size(), s_IslandGrain, [this](size_t begin, size_t end)
+        {
+            for (size_t index = begin; index < end; ++index)
+            {
+                const Island& island = m_Islands[index];
+                if (island.colorCount > 0) continue;
+                size_t beginRow = m_ManifoldRows[island.firstManifold];
+                size_t endRow = m_ManifoldRows[island.firstManifold + island.manifoldCount];
+                WarmStart(beginRow, endRow);
+                for (size_t iteration = 0; iteration < m_VelocityIterations; ++iteration) SolveVelocityConstraints(beginRow, endRow);
+            }
+        });
+        for (const Island& island : m_Islands)
+        {
+            if (island.colorCount == 0) continue;
+            ForEachColor(island, [this](size_t beginRow, size_t endRow) { WarmStart(beginRow, endRow); });
+            for (size_t iteration = 0; iteration < m_VelocityIterations; ++iteration)
+            {
+                ForEachColor(island, [this](size_t beginRow, size_t endRow) { SolveVelocityConstraints(beginRow, endRow); });
+            }
+        }
+
+        IntegratePositions(deltaTime);
+
+        // Then whatever penetration is left after moving the bodies, each island stops once nothing sinks much past the slop.
+        float tolerance = -3.0f * s_LinearSlop;
+        ParallelFor(m_Islands.size(), s_IslandGrain, [this, tolerance](size_t begin, size_t end)
+        {
+            for (size_t index = begin; index < end; ++index)
+            {
+                const Island& island = m_Islands[index];
+                if (island.colorCount > 0) continue;
+                size_t beginRow = m_ManifoldRows[island.firstManifold];
+                size_t endRow = m_ManifoldRows[island.firstManifold + island.manifoldCount];
+                for (size_t iteration = 0; iteration < m_PositionIterations; ++iteration)
+                {
+                    if (SolvePositionConstraints(beginRow, endRow) >= tolerance) break;
+                }
+            }
+        });
+        for (const Island& island : m_Islands)
+        {
+            if (island.colorCount == 0) continue;
+            for (size_t iteration = 0; iteration < m_PositionIterations; ++iteration)
+            {
+                // The minimum doesn't depend on the order the colors' blocks finish in.
+                std::atomic<float> deepest = 0.0f;
+                ForEachColor(island, [this, &deepest](size_t beginRow, size_t endRow)
+                {
+                    float separation = SolvePositionConstraints(beginRow, endRow);
+                    float current = deepest.load();
+                    while (separation < current && !deepest.compare_exchange_weak(current, separation));
+                });
+                if (deepest.load() >= tolerance) break;
+            }
+        }
+    }
+
+    void Solver::PrepareContacts()
+    {
+        m_ManifoldRows.resize(m_Manifolds.size() + 1);
+        size_t count = 0;
+        for (size_t index = 0; index < m_Manifolds.size(); ++index)
+        {
+            m_ManifoldRows[index] = static_cast<uint32_t>(count);
+            count += m_Manifolds[index].manifold->count;
+        }
+        m_ManifoldRows.back() = static_cast<uint32_t>(count);
+        m_Contacts.resize(count);
+        m_Statistics.contacts = count;
+
+        auto getEffectiveMass = [this](uint32_t bodyA, uint32_t bodyB, const Vector3& relativeA, const Vector3& relativeB, const Vector3& axis)
+        {
+            Vector3 angularA = Cross(relativeA, axis);
+            Vector3 angularB = Cross(relativeB, axis);
+            float inverseMass = m_States.inverseMass[bodyA] + m_States.inverseMass[bodyB] + Dot(angularA, m_States.inverseInertia[bodyA] * angularA) + Dot(angularB, m_States.inverseInertia[bodyB] * angularB);
+            return inverseMass > 0.0f ? 1.0f / inverseMass : 0.0f;
+        };
+
+        size_t row = 0;
+        for (const ContactManifold& contact : m_Manifolds)
+        {
+            const Body& bodyA = m_Bodies[contact.bodyA];
+            const Body& bodyB = m_Bodies[contact.bodyB];
+            Manifold& manifold = *contact.manifold;
+
+            // Any pair of axes orthogonal to the normal works for friction, the warm start impulse is projected onto them.
+            Vector3 normal = manifold.normal;
+            Vector3 tangentU = Abs(normal.x) >= 0.57735f ? Normalized(Vector3(normal.y, -normal.x, 0.0f)) : Normalized(Vector3(0.0f, normal.z, -normal.y));
+            Vector3 tangentV = Cross(normal, tangentU);
+            float friction = (bodyA.physics->GetFriction() + bodyB.physics->GetFriction()) * 0.5f;
+            float restitution = Min(bodyA.physics->GetRestitution(), bodyB.physics->GetRestitution());
+
+            for (size_t index = 0; index < manifold.count; ++index, ++row)
+            {
+                ManifoldPoint& point = manifold.points[index];
+                Vector3 relativeA = point.pointA - m_States.position[contact.bodyA];
+                Vector3 relativeB = point.pointB - m_States.position[contact.bodyB];
+
+                m_Contacts.bodyA[row] = contact.bodyA;
+                m_Contacts.bodyB[row] = contact.bodyB;
+                m_Contacts.normal[row] = normal;
+                m_Contacts.tangentU[row] = tangentU;
+                m_Contacts.tangentV[row] = tangentV;
+                m_Contacts.relativeA[row] = relativeA;
+                m_Contacts.relativeB[row] = relativeB;
+                m_Contacts.anchorA[row] = Rotated(relativeA, Conjugated(m_States.orientation[contact.bodyA]));
+                m_Contacts.anchorB[row] = Rotated(relativeB, Conjugated(m_States.orientation[contact.bodyB]));
+                m_Contacts.normalMass[row] = getEffectiveMass(contact.bodyA, contact.bodyB, relativeA, relativeB, normal);
+                m_Contacts.tangentMassU[row] = getEffectiveMass(contact.bodyA, contact.bodyB, relativeA, relativeB, tangentU);
+                m_Contacts.tangentMassV[row] = getEffectiveMass(contact.bodyA, contact.bodyB, relativeA, relativeB, tangentV);
+                m_Contacts.normalImpulse[row] = point.normalImpulse;
+                m_Contacts.tangentImpulseU[row] = Dot(point.tangentImpulse, tangentU);
+                m_Contacts.tangentImpulseV[row] = Dot(point.tangentImpulse, tangentV);
+                m_Contacts.friction[row] = friction;
+                m_Contacts.points[row] = &point;
+
+                // Only approaches faster than the threshold bounce.
+                Vector3 relativeVelocity = m_States.velocity[contact.bodyB] + Cross(m_States.angularVelocity[contact.bodyB], relativeB) - m_States.velocity[contact.bodyA] - Cross(m_States.angularVelocity[contact.bodyA], relativeA);
+                float normalVelocity = Dot(relativeVelocity, normal);
+                m_Contacts.bias[row] = normalVelocity < -s_RestitutionThreshold ? -restitution * normalVelocity : 0.0f;
+            }
+        }
+    }
+    void Solver::WarmStart(size_t beginRow, size_t endRow)
+    {
+        for (size_t row = beginRow; row < endRow; ++row)
+        {
+            Vector3 impulse = m_Contacts.normal[row] * m_Contacts.normalImpulse[row] + m_Contacts.tangentU[row] * m_Contacts.tangentImpulseU[row] + m_Contacts.tangentV[row] * m_Contacts.tangentImpulseV[row];
+            ApplyImpulse(m_Contacts.bodyA[row], m_Contacts.bodyB[row], m_Contacts.relativeA[row], m_Contacts.relativeB[row], impulse);
+        }
+    }
+    void Solver::SolveVelocityConstraints(size_t beginRow, size_t endRow)
+    {
+        for (size_t row = beginRow; row < endRow; ++row)
+        {
+            uint32_t bodyA = m_Contacts.bodyA[row];
+            uint32_t bodyB = m_Contacts.bodyB[row];
+            const Vector3& relativeA = m_Contacts.relativeA[row];
+            const Vector3& relativeB = m_Contacts.relativeB[row];
+            auto getRelativeVelocity = [&]() { return m_States.velocity[bodyB] + Cross(m_States.angularVelocity[bodyB], relativeB) - m_States.velocity[bodyA] - Cross(m_States.angularVelocity[bodyA], relativeA); };
+
+            // Friction first, bounded by the normal impulse accumulated so far.
+            float limit = m_Contacts.friction[row] * m_Contacts.normalImpulse[row];
+            Vector3 relativeVelocity = getRelativeVelocity();
+            float previousU = m_Contacts.tangentImpulseU[row];
+            float previousV = m_Contacts.tangentImpulseV[row];
+            m_Contacts.tangentImpulseU[row] = Clamp(previousU - Dot(relativeVelocity, m_Contacts.tangentU[row]) * m_Contacts.tangentMassU[row], -limit, limit);
+            m_Contacts.tangentImpulseV[row] = Clamp(previousV - Dot(relativeVelocity, m_Contacts.tangentV[row]) * m_Contacts.tangentMassV[row], -limit, limit);
+            Vector3 frictionImpulse = m_Contacts.tangentU[row] * (m_Contacts.tangentImpulseU[row] - previousU) + m_Contacts.tangentV[row] * (m_Contacts.tangentImpulseV[row] - previousV);
+            ApplyImpulse(bodyA, bodyB, relativeA, relativeB, frictionImpulse);
+
+            // The accumulated normal impulse may shrink within an iteration but never pulls the bodies together.
+            relativeVelocity = getRelativeVelocity();
+            float previous = m_Contacts.normalImpulse[row];
+            m_Contacts.normalImpulse[row] = Max(previous - (Dot(relativeVelocity, m_Contacts.normal[row]) - m_Contacts.bias[row]) * m_Contacts.normalMass[row], 0.0f);
+            ApplyImpulse(bodyA, bodyB, relativeA, relativeB, m_Contacts.normal[row] * (m_Contacts.normalImpulse[row] - previous));
+        }
+    }
+    float Solver::SolvePositionConstraints(size_t beginRow, size_t endRow)
+    {
+        auto rotate = [](Quaternion& orientation, const Vector3& rotation)
+        {
+            float angle = Length(rotation);
+            if (angle > 1e-9f) orientation = Normalized(Quaternion(rotation / angle, angle) * orientation);
+        };
+
+        float deepest = 0.0f;
+        for (size_t row = beginRow; row < endRow; ++row)
+        {
+            uint32_t bodyA = m_Contacts.bodyA[row];
+            uint32_t bodyB = m_Contacts.bodyB[row];
+            const Vector3& normal = m_Contacts.normal[row];
+            float inverseMassA = m_States.inverseMass[bodyA];
+            float inverseMassB = m_States.inverseMass[bodyB];
+            const Matrix3& inverseInertiaA = m_States.inverseInertia[bodyA];
+            const Matrix3& inverseInertiaB = m_States.inverseInertia[bodyB];
+
+            // Follow the contact points with the bodies and push them apart along the step's normal.
+            Vector3 relativeA = Rotated(m_Contacts.anchorA[row], m_States.orientation[bodyA]);
+            Vector3 relativeB = Rotated(m_Contacts.anchorB[row], m_States.orientation[bodyB]);
+            float separation = Dot(m_States.position[bodyB] + relativeB - m_States.position[bodyA] - relativeA, normal);
+            deepest = Min(deepest, separation);
+            float correction = Clamp(s_Baumgarte * (separation + s_LinearSlop), -s_MaxLinearCorrection, 0.0f);
+            if (correction == 0.0f) continue;
+
+            Vector3 angularA = Cross(relativeA, normal);
+            Vector3 angularB = Cross(relativeB, normal);
+            float inverseMass = inverseMassA + inverseMassB + Dot(angularA, inverseInertiaA * angularA) + Dot(angularB, inverseInertiaB * angularB);
+            if (inverseMass <= 0.0f) continue;
+
+            Vector3 impulse = normal * (-correction / inverseMass);
+            if (inverseMassA > 0.0f)
+            {
+                m_States.position[bodyA] -= impulse * inverseMassA;
+                rotate(m_States.orientation[bodyA], -(inverseInertiaA * Cross(relativeA, impulse)));
+            }
+            if (inverseMassB > 0.0f)
+            {
+                m_States.position[bodyB] += impulse * inverseMassB;
+                rotate(m_States.orientation[bodyB], inverseInertiaB * Cross(relativeB, impulse));
+            }
+        }
+        return deepest;
+    }
+    void Solver::StoreImpulses()
+    {
+        for (size_t row = 0; row < m_Contacts.size(); ++row)
+        {
+            ManifoldPoint& point = *m_Contacts.points[row];
+            point.normalImpulse = m_Contacts.normalImpulse[row];
+            point.tangentImpulse = m_Contacts.tangentU[row] * m_Contacts.tangentImpulseU[row] + m_Contacts.tangentV[row] * m_Contacts.tangentImpulseV[row];
+        }
+    }
+
+    float Solver::GetTimeOfImpact(const ColliderVariant& colliderA, const Body& bodyA, const ColliderVariant& colliderB, const Body& bodyB)
+    {
+        // Conservative advancement: nothing on the two bodies closes in faster than the bound, so moving ahead by distance / bound never overshoots.
+        const Transform& transformA = *bodyA.transform;
+        const Transform& transformB = *bodyB.transform;
+        auto rotation = [](const Transform& transform)
+        {
+            Quaternion delta = transform.GetOrientation() * Conjugated(transform.GetPreviousOrientation());
+            return 2.0f * Arcsin(Min(Length(Vector3(delta.b, delta.c, delta.d)), 1.0f));
+        };
+        Vector3 motion = (transformA.GetPosition() - transformA.GetPreviousPosition()) - (transformB.GetPosition() - transformB.GetPreviousPosition());
+        float rotationBound = 0.0f;
+        if (!bodyA.physics->IsStationary()) rotationBound += rotation(transformA) * Length(bodyA.physics->GetCollider().GetWorldBounds(bodyA.frame).GetExtents());
+        if (!bodyB.physics->IsStationary()) rotationBound += rotation(transformB) * Length(bodyB.physics->GetCollider().GetWorldBounds(bodyB.frame).GetExtents());
+
+        float time = 0.0f;
+        SupportHints hints;
+        for (size_t iteration = 0; iteration < s_MaxTimeOfImpactIterations; ++iteration)
+        {
+            Vector3 normal;
+            float distance = GetDistance(colliderA, Interpolated(transformA, time).GetFrame(), colliderB, Interpolated(transformB, time).GetFrame(), normal, hints);
+            if (distance <= 0.0f) return time;
+            float approach = Dot(motion, normal);
+            if (distance < s_LinearSlop)
+            {
+                // Stop about the slop deep, so the next step's narrowphase sees the contact instead of the body hovering short of it.
+                return approach > 1e-6f ? Min(time + (distance + s_LinearSlop) / approach, 1.0f) : time;
+            }
+            float bound = approach + rotationBound;
+            if (bound <= 1e-6f) return 1.0f;
+            time += distance / bound;
+            if (time >= 1.0f) return 1.0f;
+        }
+        return time;
+    }
+    template <typename T>
+    float Solver::GetTrianglesTimeOfImpact(const ColliderVariant& collider, const Body& body, const Body& meshBody)
+    {
+        // Every triangle under the bounds the body covers over the step is convex on its own, the earliest touch counts.
+        const T& mesh = meshBody.physics->GetCollider().Get<T>();
+        Bounds swept = Merged(collider.GetWorldBounds(body.frame), collider.GetWorldBounds(body.transform->GetFrame()));
+        float time = 1.0f;
+        mesh.Query(GetLocalBounds(Inflated(swept, s_LinearSlop), meshBody.frame), [&](const TriangleMeshCollider::TrianglePacket& packet, uint32_t count)
+        {
+            for (size_t lane = 0; lane < count && time > 0.0f; ++lane)
+            {
+                Vector3 corners[3];
+                for (size_t vertex = 0; vertex < 3; ++vertex) corners[vertex] = Vector3(packet.vertices[vertex][0][lane], packet.vertices[vertex][1][lane], packet.vertices[vertex][2][lane]);
+                time = Min(time, GetTimeOfImpact(collider, body, ColliderVariant(TriangleCollider(corners[0], corners[1], corners[2])), meshBody));
+            }
+        });
+        return time;
+    }
+    void Solver::ClampToTimeOfImpact()
+    {
+        // Runs on the written back transforms, their previous pose is the start of the step.
+        m_TimesOfImpact.assign(m_Bodies.size(), 1.0f);
+        auto core = [](const Body& body)
+        {
+            // A sphere well inside the body as Box2D does it, a quarter of the shortest local half extent, scaled along with the body.
+            const ColliderVariant& collider = body.physics->GetCollider();
+            float extent = Min(collider.GetSupport(Vector3(1.0f, 0.0f, 0.0f)).x, Min(collider.GetSupport(Vector3(0.0f, 1.0f, 0.0f)).y, collider.GetSupport(Vector3(0.0f, 0.0f, 1.0f)).z));
+            return ColliderVariant(SphereCollider(0.25f * extent));
+        };
+        auto sweep = [this](const ColliderVariant& colliderA, const Body& bodyA, const ColliderVariant& colliderB, const Body& bodyB)
+        {
+            if (colliderB.GetShape() == Collider::Shape::TriangleMesh) return GetTrianglesTimeOfImpact<TriangleMeshCollider>(colliderA, bodyA, bodyB);
+            if (colliderA.GetShape() == Collider::Shape::TriangleMesh) return GetTrianglesTimeOfImpact<TriangleMeshCollider>(colliderB, bodyB, bodyA);
+            if (colliderB.GetShape() == Collider::Shape::Heightfield) return GetTrianglesTimeOfImpact<HeightfieldCollider>(colliderA, bodyA, bodyB);
+            if (colliderA.GetShape() == Collider::Shape::Heightfield) return GetTrianglesTimeOfImpact<HeightfieldCollider>(colliderB, bodyB, bodyA);
+            return GetTimeOfImpact(colliderA, bodyA, colliderB, bodyB);
+        };
+        for (auto [a, b] : m_Pairs)
+        {
+            Body& bodyA = m_Bodies[a];
+            Body& bodyB = m_Bodies[b];
+            if (!bodyA.continuous && !bodyB.continuous) continue;
+            float time = sweep(bodyA.physics->GetCollider(), bodyA, bodyB.physics->GetCollider(), bodyB);
+
+            // Pairs already touching at the start are the contact solver's, only the cores are swept so the touch can't carry the body through.
+            if (time == 0.0f)
+            {
+                time = sweep(bodyA.continuous ? core(bodyA) : bodyA.physics->GetCollider(), bodyA, bodyB.continuous ? core(bodyB) : bodyB.physics->GetCollider(), bodyB);
+                if (time == 0.0f) continue;
+            }
+            if (bodyA.continuous) m_TimesOfImpact[a] = Min(m_TimesOfImpact[a], time);
+            if (bodyB.continuous) m_TimesOfImpact[b] = Min(m_TimesOfImpact[b], time);
+        }
+
+        // Swept bodies give up the rest of the step and keep their velocity, the contact solver takes over next step.
+        for (size_t index = 0; index < m_Bodies.size(); ++index)
+        {
+            Body& body = m_Bodies[index];
+            if (!body.continuous) continue;
+            ++m_Statistics.continuousBodies;
+            if (m_TimesOfImpact[index] >= 1.0f) continue;
+            ++m_Statistics.continuousClamps;
+            Transform pose = Interpolated(*body.transform, m_TimesOfImpact[index]);
+            body.transform->TranslateTo(pose.GetPosition());
+            body.transform->RotateTo(pose.GetOrientation());
+        }
+    }
+
+    float Solver::Simulate(World& world, float frameTime)
+    {
+        // Physics always advances in whole fixed steps, the remainder carries over to the next frame.
+        m_Accumulator += Max(frameTime, 0.0f);
+        size_t steps = 0;
+        for (; m_Accumulator >= m_FixedTimeStep && steps < m_MaxSteps; ++steps)
+        {
+            Solve(world, m_FixedTimeStep);
+            m_Accumulator -= m_FixedTimeStep;
+        }
+        if (steps == m_MaxSteps) m_Accumulator = Min(m_Accumulator, m_FixedTimeStep);
+
+        // How far rendering should blend from the previous step to the current one.
+        return Min(m_Accumulator / m_FixedTimeStep, 1.0f);
+    }
+    void Solver::Solve(World& world, float deltaTime)
+    {
+        deltaTime = Clamp(deltaTime, 0.0f, 1.0f);
+        float substepTime = deltaTime / m_Substeps;
+        m_Statistics = Statistics();
+        m_Bodies.clear();
+        m_Proxies.clear();
+        for (auto [handle, transform, physics] : world.View<Transform, Physics>())
+        {
+            if (!m_SleepEnabled) physics.Wake();
+            transform.StorePreviousPose();
+            m_Bodies.emplace_back(handle, &transform, &physics, transform.GetFrame(), false);
+        }
+
+        // Sleeping bodies hold still like stationary ones until something wakes them.
+        m_States.resize(m_Bodies.size());
+        for (uint32_t index = 0; index < m_Bodies.size(); ++index)
+        {
+            const Body& body = m_Bodies[index];
+            const Physics& physics = *body.physics;
+            m_States.position[index] = body.frame.position;
+            m_States.orientation[index] = body.transform->GetOrientation();
+            m_States.velocity[index] = physics.GetVelocity();
+            m_States.angularVelocity[index] = physics.GetAngularVelocity();
+            if (!physics.IsStationary() && !physics.IsSleeping())
+            {
+                SetDynamics(index);
+                continue;
+            }
+            m_States.acceleration[index] = Vector3(0.0f);
+            m_States.angularAcceleration[index] = Vector3(0.0f);
+            m_States.inverseMass[index] = 0.0f;
+            m_States.inverseInertia[index] = Matrix3(0.0f);
+            m_States.drag[index] = 0.0f;
+            m_States.moving[index] = 0.0f;
+        }
+        IntegrateVelocities(substepTime);
+
+        for (uint32_t index = 0; index < m_Bodies.size(); ++index)
+        {
+            Body& body = m_Bodies[index];
+            const Physics& physics = *body.physics;
+            Bounds bounds = physics.GetCollider().GetWorldBounds(body.frame);
+
+            // Fast continuous bodies pair up with everything along their motion, and are swept against those pairs after the solve.
+            if (physics.IsContinuous() && m_States.moving[index] > 0.0f)
+            {
+                Vector3 motion = m_States.velocity[index] * deltaTime;
+                Vector3 extents = bounds.GetExtents();
+                body.continuous = LengthSquared(motion) > Square(s_ContinuousMotion * Min(extents.x, Min(extents.y, extents.z)));
+                if (body.continuous) bounds = Merged(bounds, Bounds(bounds.min + motion, bounds.max + motion));
+            }
+            m_Proxies.push_back({ static_cast<uint32_t>(entt::to_entity(body.handle)), bounds });
+        }
+        mp_Broadphase->Update(m_Proxies, m_Pairs);
+        ++m_Stamp;
+
+        // Keep the table at most half full, it only ever grows so steady state steps do not allocate.
+        std::swap(m_PairCache, m_PreviousPairCache);
+        size_t capacity = 16;
+        while (capacity < 2 * m_Pairs.size()) capacity *= 2;
+        if (capacity > m_PairCache.size()) m_PairCache.assign(capacity, PairCache());
+        m_IslandParents.resize(m_Bodies.size());
+        std::iota(m_IslandParents.begin(), m_IslandParents.end(), 0);
+        m_NarrowphasePairs.clear();
+        for (auto [a, b] : m_Pairs)
+        {
+            // Cached state is stored for the pair ordered by id, so it reads the same way every step.
+            if (m_Proxies[a].id > m_Proxies[b].id) std::swap(a, b);
+            Body& bodyA = m_Bodies[a];
+            Body& bodyB = m_Bodies[b];
+            bool stationaryA = bodyA.physics->IsStationary();
+            bool stationaryB = bodyB.physics->IsStationary();
+            if (stationaryA && stationaryB) continue;
+
+            // The table isn't safe to insert into from several threads, every entry is made here first.
+            bool cached;
+            PairCache& cache = GetPairCache(static_cast<uint64_t>(m_Proxies[a].id) << 32 | m_Proxies[b].id, cached);
+
+            // Pairs where neither body moves keep their cached state, it still ties sleeping bodies into islands.
+            if ((stationaryA || bodyA.physics->IsSleeping()) && (stationaryB || bodyB.physics->IsSleeping()))
+            {
+                if (!stationaryA && !stationaryB && cache.manifold.count > 0) MergeIslands(a, b);
+                continue;
+            }
+            m_NarrowphasePairs.push_back({ a, b, &cache, cached });
+        }
+        UpdateNarrowphase();
+
+        BuildIslands();
+        PrepareContacts();
+
+        // Substeps reuse the pairs and contact rows found above, only integration and the contact solve run again.
+        for (size_t substep = 0; substep < m_Substeps; ++substep)
+        {
+            if (substep > 0) IntegrateVelocities(substepTime);
+            SolveIslands(substepTime);
+        }
+        StoreImpulses();
+
+        for (uint32_t index = 0; index < m_Bodies.size(); ++index)
+        {
+            const Body& body = m_Bodies[index];
+            if (body.physics->IsStationary() || body.physics->IsSleeping()) continue;
+
+            body.physics->ResetAccumulators();
+            body.physics->SetVelocity(m_States.velocity[index]);
+            body.physics->SetAngularVelocity(m_States.angularVelocity[index]);
+            body.transform->TranslateTo(m_States.position[index]);
+            body.transform->RotateTo(m_States.orientation[index]);
+        }
+        ClampToTimeOfImpact();
+        UpdateSleep(deltaTime);
+
+        if (m_Statistics.gjkQueries > 0)
+        {
+            m_Statistics.gjkHitRate = static_cast<float>(m_Statistics.gjkCacheHits) / m_Statistics.gjkQueries;
+            m_Statistics.gjkAverageIterations = static_cast<float>(m_Statistics.gjkIterations) / m_Statistics.gjkQueries;
+        }
+        if (m_Statistics.epaQueries > 0) m_Statistics.epaAverageIterations = static_cast<float>(m_Statistics.epaIterations) / m_Statistics.epaQueries;
     }
-}
\ No newline at end of file
+}
@@ -6,6 +6,15 @@ namespace Engine
     Vector3 Transform::GetPosition() const { return m_Position; }
     Quaternion Transform::GetOrientation() const { return m_Orientation; }
     Quaternion Transform::GetInverseOrientation() const { return Conjugated(m_Orientation); }
+    bool Transform::HasPreviousPose() const { return m_HasPreviousPose; }
+    Vector3 Transform::GetPreviousPosition() const { return m_PreviousPosition; }
+    Quaternion Transform::GetPreviousOrientation() const { return m_PreviousOrientation; }
+    void Transform::StorePreviousPose()
+    {
+        m_PreviousPosition = m_Position;
+        m_PreviousOrientation = m_Orientation;
+        m_HasPreviousPose = true;
+    }
     Matrix4 Transform::GetScalingMatrix() const
     { 
         return Matrix4(
@@ -54,12 +63,23 @@ namespace Engine
         return result;
     }
     Matrix4 Transform::GetInverseWorldMatrix() const { return GetInverseScalingMatrix() * GetInverseRotationMatrix() * GetInverseTranslationMatrix(); }
+    Frame Transform::GetFrame() const
+    {
+        Frame frame;
+        frame.rotation = Matrix3(m_Orientation);
+        frame.scale = m_Scale;
+        frame.position = m_Position;
+        frame.linear = Matrix3(frame.rotation[0] * m_Scale.x, frame.rotation[1] * m_Scale.y, frame.rotation[2] * m_Scale.z);
+        frame.inverseLinear = Matrix3(Vector3(1.0f / m_Scale.x, 1.0f / m_Scale.y, 1.0f / m_Scale.z)) * Transposed(frame.rotation);
+        return frame;
+    }
     void Transform::TranslateTo(const Vector3& position) { m_Position = position; }
     void Transform::TranslateBy(const Vector3& delta) { m_Position += delta; }
     void Transform::TranslateTo(float x, float y, float z) { m_Position = Vector3(x, y, z); }
     void Transform::TranslateBy(float deltaX, float deltaY, float deltaZ) { m_Position += Vector3(deltaX, deltaY, deltaZ); }
     void Transform::RotateAround(const Vector3& vector, float radians) { m_Orientation = Normalized(Quaternion(Normalized(vector), radians) * m_Orientation); }
     void Transform::RotateTo(float angleAroundX, float angleAroundY, float angleAroundZ) { m_Orientation = Quaternion(angleAroundX, angleAroundY, angleAroundZ); }
+    void Transform::RotateTo(const Quaternion& orientation) { m_Orientation = orientation; }
     void Transform::RotateBy(float deltaAngleAroundX, float deltaAngleAroundY, float deltaAngleAroundZ)
     {
         Quaternion delta = Quaternion(deltaAngleAroundX, deltaAngleAroundY, deltaAngleAroundZ);
@@ -67,4 +87,19 @@ namespace Engine
     }
     void Transform::ScaleTo(float scaleX, float scaleY, float scaleZ) { m_Scale = Vector3(scaleX, scaleY, scaleZ); }
     void Transform::ScaleBy(float scalarX, float scalarY, float scalarZ) { m_Scale = Hadamard(Vector3(scalarX, scalarY, scalarZ), m_Scale); }
+
+    Transform Interpolated(const Transform& transform, float alpha)
+    {
+        if (!transform.HasPreviousPose()) return transform;
+
+        // Steps are short, a normalized lerp along the shorter arc is close enough to a slerp.
+        Quaternion previous = transform.GetPreviousOrientation();
+        Quaternion current = transform.GetOrientation();
+        if (Dot(previous, current) < 0.0f) current = -current;
+
+        Transform result = transform;
+        result.TranslateTo(transform.GetPreviousPosition() + (transform.GetPosition() - transform.GetPreviousPosition()) * alpha);
+        result.RotateTo(Normalized(previous * (1.0f - alpha) + current * alpha));
+        return result;
+    }
 }
@@ -42,7 +42,7 @@ int main(void)
         surface.Add<Transform>(surfaceTransform);
         surface.Add<Mesh>(Mesh("./assets/meshes/surface.obj"));
         surface.Add<Texture>(Texture("./assets/textures/stone.png"));
-        surface.Add<Physics>(Physics(PlaneCollider(1000), true));
+        surface.Add<Physics>(Physics(TriangleMeshCollider("./assets/meshes/surface.obj"), true));
     }
 
     {
@@ -54,7 +54,9 @@ int main(void)
         cube.Add<Transform>(cubeTransform);
         cube.Add<Mesh>(Mesh("./assets/meshes/cube.obj"));
         cube.Add<Texture>(Texture("./assets/textures/dirt.png"));
-        cube.Add<Physics>(Physics(CubeCollider(2), 4.0f));
+        Physics cubePhysics = Physics(CubeCollider(2), 4.0f);
+        cubePhysics.SetContinuous(true);
+        cube.Add<Physics>(cubePhysics);
         cube.Add<Controllable>();
     }
 
@@ -98,8 +100,8 @@ int main(void)
         now = chrono::high_resolution_clock::now();
         window.SetTitle(format("FPS: {:.2f}", 1.0f / deltaTime));
         input.Control(world, window, deltaTime);
-        solver.Solve(world, deltaTime);
-        renderer.Render(world, window);
+        float alpha = solver.Simulate(world, deltaTime);
+        renderer.Render(world, window, alpha);
 
         ++frames;
     }
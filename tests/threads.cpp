@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <engine/core/world.hpp>
+#include <engine/core/object.hpp>
+#include <engine/core/physics.hpp>
+#include <engine/core/solver.hpp>
+#include <engine/core/transform.hpp>
+#include <engine/core/collider.hpp>
+
+using namespace Engine;
+
+// Steps the same scene with one, two and many threads and checks every body's pose and velocities match bit for bit after every step.
+// A wall of stacked cubes makes an island large enough to be colored and solved a color at a time across threads,
+// small stacks of spheres, ellipsoids and hulls next to it are solved whole, a few islands to a task.
+
+namespace
+{
+    constexpr size_t s_Steps = 90;
+
+    struct Scene
+    {
+        World world;
+        Solver solver;
+        std::vector<Handle> handles;
+    };
+
+    void Populate(Scene& scene, size_t threads)
+    {
+        std::vector<Vector3> hull;
+        for (size_t index = 0; index < 8; ++index) hull.push_back(Vector3((index & 1) ? 0.9f : -0.9f, (index & 2) ? 0.7f : -0.7f, (index & 4) ? 0.8f : -0.8f));
+        hull.push_back(Vector3(0.0f, 0.0f, 1.2f));
+
+        Object ground = scene.world.Create();
+        ground.Add<Transform>(Transform());
+        ground.Add<Physics>(Physics(PlaneCollider(200.0f), true));
+
+        auto add = [&scene](const Transform& transform, Physics physics)
+        {
+            Object object = scene.world.Create();
+            object.Add<Transform>(transform);
+            object.Add<Physics>(physics);
+            scene.handles.push_back(object.GetHandle());
+        };
+        for (size_t layer = 0; layer < 6; ++layer)
+        {
+            for (size_t row = 0; row < 8; ++row)
+            {
+                for (size_t column = 0; column < 8; ++column)
+                {
+                    Transform transform;
+                    transform.TranslateTo(2.0f * row + 0.05f * (layer % 2), 2.0f * column, 1.0f + 2.0f * layer);
+                    add(transform, Physics(CubeCollider(2.0f)));
+                }
+            }
+        }
+        for (size_t stack = 0; stack < 12; ++stack)
+        {
+            for (size_t layer = 0; layer < 3; ++layer)
+            {
+                Transform transform;
+                transform.TranslateTo(30.0f + 4.0f * (stack % 4), 4.0f * (stack / 4), 1.0f + 2.1f * layer);
+                transform.RotateBy(Radians(10.0f * stack), Radians(5.0f * layer), 0.0f);
+                if (stack % 3 == 0) add(transform, Physics(SphereCollider(1.0f)));
+                else if (stack % 3 == 1)
+                {
+                    transform.ScaleTo(1.0f, 0.8f, 0.9f);
+                    add(transform, Physics(SphereCollider(1.0f)));
+                }
+                else add(transform, Physics(ConvexHullCollider(hull)));
+            }
+        }
+        scene.solver.SetSleepEnabled(false);
+        scene.solver.SetThreadCount(threads);
+    }
+
+    bool Same(const Vector3& a, const Vector3& b) { return std::memcmp(&a.x, &b.x, 3 * sizeof(float)) == 0; }
+    bool Same(const Quaternion& a, const Quaternion& b) { return std::memcmp(&a.a, &b.a, 4 * sizeof(float)) == 0; }
+}
+
+int main()
+{
+    size_t many = std::max<size_t>(std::thread::hardware_concurrency(), 4);
+    size_t threadCounts[] = { 1, 2, many };
+    std::vector<std::unique_ptr<Scene>> scenes;
+    for (size_t threads : threadCounts)
+    {
+        scenes.push_back(std::make_unique<Scene>());
+        Populate(*scenes.back(), threads);
+    }
+
+    size_t coloredIslands = 0;
+    for (size_t step = 0; step < s_Steps; ++step)
+    {
+        for (std::unique_ptr<Scene>& scene : scenes) scene->solver.Solve(scene->world, 1.0f / 60.0f);
+        coloredIslands += scenes[0]->solver.GetStatistics().coloredIslands;
+
+        Scene& reference = *scenes[0];
+        for (size_t scene = 1; scene < scenes.size(); ++scene)
+        {
+            for (size_t index = 0; index < reference.handles.size(); ++index)
+            {
+                Object a = reference.world.Get(reference.handles[index]);
+                Object b = scenes[scene]->world.Get(scenes[scene]->handles[index]);
+                if (!Same(a.Get<Transform>().GetPosition(), b.Get<Transform>().GetPosition()) || !Same(a.Get<Transform>().GetOrientation(), b.Get<Transform>().GetOrientation()) ||
+                    !Same(a.Get<Physics>().GetVelocity(), b.Get<Physics>().GetVelocity()) || !Same(a.Get<Physics>().GetAngularVelocity(), b.Get<Physics>().GetAngularVelocity()))
+                {
+                    std::printf("FAIL: body %zu differs between 1 and %zu threads at step %zu\n", index, threadCounts[scene], step);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    std::printf("%zu bodies, %zu steps, 1, 2 and %zu threads: identical, %zu colored islands over all steps\n", scenes[0]->handles.size(), s_Steps, many, coloredIslands);
+    if (coloredIslands == 0)
+    {
+        std::printf("FAIL: no island was colored, the scene no longer covers the threaded island solve\n");
+        return 1;
+    }
+    std::printf("OK\n");
+    return 0;
+}